@@ -0,0 +1,90 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+// Фоновое декодирование картинок несколькими потоками.
+// Потоки разбирают очередь файлов по одному (кто освободился, берет следующий),
+// а загрузка в видеопамять остается главному потоку: готовые sf::Image
+// отдаются через forEachLoaded и перемещаются, а не копируются.
+class AssetLoader {
+private:
+    struct Job {
+        std::string name;
+        std::string file;
+        sf::Image image;
+        bool loaded = false;
+    };
+
+    std::vector<Job> jobs;
+    std::vector<std::thread> workers;
+    std::atomic<std::size_t> nextJob{0};
+    std::atomic<std::size_t> completed{0};
+
+    void work() {
+        for (;;) {
+            std::size_t index = nextJob.fetch_add(1);
+            if (index >= jobs.size()) {
+                return;
+            }
+            jobs[index].loaded = jobs[index].image.loadFromFile(jobs[index].file);
+            completed.fetch_add(1);
+        }
+    }
+
+public:
+    AssetLoader() = default;
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    ~AssetLoader() {
+        cancel();
+        wait();
+    }
+
+    // Очередь заполняется до start()
+    void add(const std::string& name, const std::string& file) {
+        jobs.push_back({name, file, sf::Image(), false});
+    }
+
+    // Число потоков по умолчанию - по числу ядер, но не больше числа файлов
+    void start(unsigned threadCount = std::thread::hardware_concurrency()) {
+        std::size_t count = std::min<std::size_t>(std::max(threadCount, 1u), jobs.size());
+        for (std::size_t i = 0; i < count; ++i) {
+            workers.emplace_back(&AssetLoader::work, this);
+        }
+    }
+
+    std::size_t total() const { return jobs.size(); }
+    std::size_t done() const { return completed.load(); }
+    bool finished() const { return done() == jobs.size(); }
+
+    // Оставшиеся файлы не будут загружены (например, окно закрыли)
+    void cancel() {
+        std::size_t skipped = nextJob.exchange(jobs.size());
+        if (skipped < jobs.size()) {
+            completed.fetch_add(jobs.size() - skipped);
+        }
+    }
+
+    void wait() {
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    // Обход загруженных картинок после wait(); картинку можно забрать std::move
+    template <typename Visitor>
+    void forEachLoaded(Visitor visit) {
+        for (auto& job : jobs) {
+            if (job.loaded) {
+                visit(job.name, job.image);
+            }
+        }
+    }
+};
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include "mapped_file.hpp"
+
+// Формат пакета картинок (.pack), все числа LE:
+//   "RRPK", версия (u32), число картинок (u32), 0 (u32)
+//   индекс: на каждую картинку имя (32 байта), группа (32 байта),
+//           номер кадра (u32), ширина (u32), высота (u32), 0 (u32), смещение (u64)
+//   пиксели RGBA8 без сжатия, каждая картинка выровнена на 16 байт
+// Группа и кадр берутся из имени: run3 -> группа "run", кадр 3.
+
+const std::uint32_t ASSET_PACK_VERSION = 1;
+const std::size_t ASSET_PACK_HEADER_SIZE = 16;
+const std::size_t ASSET_PACK_ENTRY_SIZE = 88;
+const std::size_t ASSET_PACK_NAME_SIZE = 32;
+
+struct AssetPackEntry {
+    std::string name;
+    std::string group;
+    std::uint32_t frame = 0;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint64_t offset = 0;
+};
+
+// Картинка для записи в пакет
+struct AssetPackImage {
+    std::string name;
+    std::uint32_t width;
+    std::uint32_t height;
+    const std::uint8_t* pixels;
+};
+
+inline void splitFrameName(const std::string& name, std::string& group, std::uint32_t& frame) {
+    std::size_t digits = name.size();
+    while (digits > 0 && name[digits - 1] >= '0' && name[digits - 1] <= '9') {
+        digits--;
+    }
+    group = name.substr(0, digits);
+    frame = digits < name.size() ? static_cast<std::uint32_t>(std::stoul(name.substr(digits))) : 0;
+}
+
+inline bool writeAssetPack(const std::string& path, const std::vector<AssetPackImage>& images) {
+    std::vector<unsigned char> bytes;
+    auto put32 = [&bytes](std::uint32_t value) {
+        for (int i = 0; i < 4; ++i) bytes.push_back(static_cast<unsigned char>(value >> (i * 8)));
+    };
+    auto put64 = [&bytes](std::uint64_t value) {
+        for (int i = 0; i < 8; ++i) bytes.push_back(static_cast<unsigned char>(value >> (i * 8)));
+    };
+    auto putName = [&bytes](const std::string& text) {
+        for (std::size_t i = 0; i < ASSET_PACK_NAME_SIZE; ++i) {
+            bytes.push_back(i < text.size() && i + 1 < ASSET_PACK_NAME_SIZE ? static_cast<unsigned char>(text[i]) : 0);
+        }
+    };
+    auto align = [](std::uint64_t value) { return (value + 15) & ~static_cast<std::uint64_t>(15); };
+    
+    bytes.insert(bytes.end(), {'R', 'R', 'P', 'K'});
+    put32(ASSET_PACK_VERSION);
+    put32(static_cast<std::uint32_t>(images.size()));
+    put32(0);
+    
+    std::uint64_t offset = align(ASSET_PACK_HEADER_SIZE + ASSET_PACK_ENTRY_SIZE * images.size());
+    for (const auto& image : images) {
+        std::string group;
+        std::uint32_t frame = 0;
+        splitFrameName(image.name, group, frame);
+        putName(image.name);
+        putName(group);
+        put32(frame);
+        put32(image.width);
+        put32(image.height);
+        put32(0);
+        put64(offset);
+        offset = align(offset + static_cast<std::uint64_t>(image.width) * image.height * 4);
+    }
+    
+    for (const auto& image : images) {
+        bytes.resize(align(bytes.size()), 0);
+        bytes.insert(bytes.end(), image.pixels, image.pixels + static_cast<std::size_t>(image.width) * image.height * 4);
+    }
+    
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(file);
+}
+
+// Пакет, отображенный в память: пиксели читаются прямо из отображения
+class AssetPack {
+private:
+    MappedFile file;
+    std::vector<AssetPackEntry> entries;
+    
+    static std::uint32_t read32(const unsigned char* data) {
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) value |= static_cast<std::uint32_t>(data[i]) << (i * 8);
+        return value;
+    }
+    
+    static std::uint64_t read64(const unsigned char* data) {
+        std::uint64_t value = 0;
+        for (int i = 0; i < 8; ++i) value |= static_cast<std::uint64_t>(data[i]) << (i * 8);
+        return value;
+    }
+    
+    static std::string readName(const unsigned char* data) {
+        std::size_t length = 0;
+        while (length < ASSET_PACK_NAME_SIZE && data[length] != 0) {
+            length++;
+        }
+        return std::string(reinterpret_cast<const char*>(data), length);
+    }
+
+public:
+    bool open(const std::string& path) {
+        entries.clear();
+        if (!file.open(path)) {
+            return false;
+        }
+        
+        const unsigned char* data = file.data();
+        std::size_t size = file.size();
+        if (size < ASSET_PACK_HEADER_SIZE || std::memcmp(data, "RRPK", 4) != 0 || read32(data + 4) != ASSET_PACK_VERSION) {
+            file.close();
+            return false;
+        }
+        
+        std::uint64_t count = read32(data + 8);
+        if (ASSET_PACK_HEADER_SIZE + ASSET_PACK_ENTRY_SIZE * count > size) {
+            file.close();
+            return false;
+        }
+        
+        for (std::size_t i = 0; i < count; ++i) {
+            const unsigned char* record = data + ASSET_PACK_HEADER_SIZE + ASSET_PACK_ENTRY_SIZE * i;
+            AssetPackEntry entry;
+            entry.name = readName(record);
+            entry.group = readName(record + ASSET_PACK_NAME_SIZE);
+            entry.frame = read32(record + 64);
+            entry.width = read32(record + 68);
+            entry.height = read32(record + 72);
+            entry.offset = read64(record + 80);
+            
+            // Картинка должна целиком лежать в файле
+            std::uint64_t pixelBytes = static_cast<std::uint64_t>(entry.width) * entry.height * 4;
+            if (entry.offset > size || pixelBytes > size - entry.offset) {
+                entries.clear();
+                file.close();
+                return false;
+            }
+            entries.push_back(entry);
+        }
+        return true;
+    }
+    
+    bool isOpen() const { return file.isOpen(); }
+    
+    const std::vector<AssetPackEntry>& getEntries() const { return entries; }
+    
+    const AssetPackEntry* find(const std::string& name) const {
+        for (const auto& entry : entries) {
+            if (entry.name == name) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    }
+    
+    const std::uint8_t* pixels(const AssetPackEntry& entry) const {
+        return file.data() + entry.offset;
+    }
+};
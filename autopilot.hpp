@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cfloat>
+#include "game_world.hpp"
+
+// Автопилот: перед каждым тиком перебирает ходы на несколько секунд вперед.
+// Ход - ничего не делать или одна из команд. Поиск идет на копиях мира: на
+// каждом из depth уровней пробуются все осмысленные ходы, копия проматывается
+// на segmentTicks тиков, на последнем уровне - до конца горизонта без нажатий.
+// Лучший план - тот, где забег дольше жив, а при равной живучести выше счет
+// и больше мопедов в запасе. Случайности нет, так что забег с автопилотом
+// повторяется по seed и годится как эталонный.
+class Autopilot {
+public:
+    static const int CHOICES = 5; // Ничего или Command::LANE_LEFT .. Command::MOPED
+
+    int depth = 2;
+    int segmentTicks = TICK_RATE / 4;
+    int horizonTicks = TICK_RATE * 5 / 2;
+
+    // Производительность поиска: тики, просчитанные на копиях, и время на это
+    long long statesEvaluated = 0;
+    double searchSeconds = 0.0;
+
+private:
+    // Копия мира на каждый уровень поиска; память выделяется один раз
+    std::vector<GameWorld> scratch;
+
+    // Ход, который ничего не изменит, не перебирается
+    static bool useful(const GameWorld& world, int choice) {
+        const Jump& jump = world.player<Jump>();
+        int lane = world.player<Lane>().lane;
+        switch (choice) {
+            case 1: return lane > 0;
+            case 2: return lane < 2;
+            case 3: return !jump.rising && !jump.falling;
+            case 4: return world.mopedCount > 0 && !world.isMopedActive;
+            default: return true;
+        }
+    }
+
+    static Command commandOf(int choice) {
+        return static_cast<Command>(choice - 1);
+    }
+
+    static double evaluate(const GameWorld& world) {
+        if (world.gameOver) {
+            return -1e12 + static_cast<double>(world.tick); // Чем позже смерть, тем лучше
+        }
+        return world.score + 100.0 * world.mopedCount;
+    }
+
+    void roll(GameWorld& world, int ticks) {
+        for (int i = 0; i < ticks && !world.gameOver; ++i) {
+            world.step();
+            statesEvaluated++;
+        }
+    }
+
+    // Оценка лучшего плана из состояния from; bestChoice - первый ход этого плана.
+    // from - копия уровнем выше (или сам мир), scratch[level] пишется заново на каждый ход.
+    double search(const GameWorld& from, int level, int& bestChoice) {
+        double best = -DBL_MAX;
+        bestChoice = 0;
+        bool last = level + 1 >= depth;
+        int ticks = last ? horizonTicks - level * segmentTicks : segmentTicks;
+        for (int choice = 0; choice < CHOICES; ++choice) {
+            if (!useful(from, choice)) {
+                continue;
+            }
+            GameWorld& world = scratch[level];
+            world = from;
+            if (choice != 0) {
+                world.applyCommand(commandOf(choice));
+            }
+            roll(world, ticks);
+
+            double value;
+            if (last || world.gameOver) {
+                value = evaluate(world);
+            } else {
+                int next;
+                value = search(world, level + 1, next);
+            }
+            // При равенстве остается более ранний ход, то есть "ничего"
+            if (value > best) {
+                best = value;
+                bestChoice = choice;
+            }
+        }
+        return best;
+    }
+
+public:
+    // Команда на этот тик; false - лучше ничего не нажимать
+    bool choose(const GameWorld& world, Command& command) {
+        if (world.gameOver || depth <= 0) {
+            return false;
+        }
+        auto start = std::chrono::steady_clock::now();
+        if (scratch.size() < static_cast<std::size_t>(depth)) {
+            scratch.resize(depth);
+        }
+        int choice;
+        search(world, 0, choice);
+        searchSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        if (choice == 0) {
+            return false;
+        }
+        command = commandOf(choice);
+        return true;
+    }
+
+    double statesPerSecond() const {
+        return searchSeconds > 0.0 ? statesEvaluated / searchSeconds : 0.0;
+    }
+};
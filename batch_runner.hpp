@@ -0,0 +1,236 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <string>
+#include <ostream>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include "game_world.hpp"
+#include "input_policy.hpp"
+#include "work_stealing_pool.hpp"
+
+// Пакетные прогоны для баланса: тысячи забегов без окна на всех ядрах.
+// Каждая конфигурация (частота препятствий, частота и веса бустов) играется
+// gamesPerConfig раз с seed, seed + 1, ... - у всех конфигураций одни и те же
+// seed, так что разница в отчете идет от настроек, а не от случайности.
+
+const char* const BOOST_NAMES[BOOST_TYPE_COUNT] = {"beer", "ruble", "energy", "seeds", "macasin", "moped"};
+
+// Настройки баланса одной конфигурации
+struct BatchConfig {
+    int obstacleSpawnTicks = GameWorld::OBSTACLE_SPAWN_TICKS;
+    int boostSpawnTicks = GameWorld::BOOST_SPAWN_TICKS;
+    int boostWeights[BOOST_TYPE_COUNT] = {1, 1, 1, 1, 1, 1};
+    
+    void apply(GameWorld& world) const {
+        world.obstacleSpawnTicks = obstacleSpawnTicks;
+        world.boostSpawnTicks = boostSpawnTicks;
+        std::copy(boostWeights, boostWeights + BOOST_TYPE_COUNT, world.boostWeights);
+    }
+};
+
+// Что нужно прогнать
+struct BatchJob {
+    std::vector<BatchConfig> configs;
+    int gamesPerConfig = 1000;
+    std::uint64_t seed = 0;
+    std::string policyName = "dodge";
+    InputPolicy policy = dodgePolicy;
+    long long maxTicks = TICK_RATE * 600; // Забег дольше 10 минут обрывается
+};
+
+// Итог одного забега
+struct GameResult {
+    int score = 0;
+    long long ticks = 0;
+    bool died = false;
+    int pickups[BOOST_TYPE_COUNT] = {};
+};
+
+// Сводка по конфигурации
+struct BatchStats {
+    BatchConfig config;
+    int games = 0;
+    int deaths = 0;
+    double scoreMean = 0.0;
+    double scoreStddev = 0.0;
+    int scoreMin = 0;
+    int scoreP10 = 0;
+    int scoreP50 = 0;
+    int scoreP90 = 0;
+    int scoreMax = 0;
+    double survivalMean = 0.0; // Секунды
+    double survivalP50 = 0.0;
+    double pickupsPerMinute[BOOST_TYPE_COUNT] = {};
+};
+
+struct BatchReport {
+    std::vector<BatchStats> stats;
+    long long totalTicks = 0;
+    double seconds = 0.0;
+    unsigned threads = 0;
+};
+
+// Один забег до смерти или до maxTicks в уже выделенном мире
+inline GameResult playGame(GameWorld& world, const BatchConfig& config, InputPolicy policy,
+                           std::uint64_t seed, long long maxTicks) {
+    config.apply(world);
+    world.reset(seed);
+    Rng input;
+    input.seed(~seed);
+    while (!world.gameOver && world.tick < maxTicks) {
+        policy(world, input);
+        world.step();
+    }
+    
+    GameResult result;
+    result.score = world.score;
+    result.ticks = world.tick;
+    result.died = world.gameOver;
+    std::copy(world.boostPickups, world.boostPickups + BOOST_TYPE_COUNT, result.pickups);
+    return result;
+}
+
+// Значение по перцентилю в отсортированном массиве (ближайший ранг)
+template <typename T>
+T percentile(const std::vector<T>& sorted, int percent) {
+    return sorted[(sorted.size() - 1) * percent / 100];
+}
+
+inline BatchStats summarize(const BatchConfig& config, const GameResult* results, int games) {
+    BatchStats stats;
+    stats.config = config;
+    stats.games = games;
+    if (games <= 0) {
+        return stats;
+    }
+    
+    std::vector<int> scores(games);
+    std::vector<long long> ticks(games);
+    double scoreSum = 0.0;
+    double scoreSquares = 0.0;
+    long long tickSum = 0;
+    long long pickups[BOOST_TYPE_COUNT] = {};
+    for (int i = 0; i < games; ++i) {
+        const GameResult& result = results[i];
+        scores[i] = result.score;
+        ticks[i] = result.ticks;
+        scoreSum += result.score;
+        scoreSquares += static_cast<double>(result.score) * result.score;
+        tickSum += result.ticks;
+        stats.deaths += result.died ? 1 : 0;
+        for (int type = 0; type < BOOST_TYPE_COUNT; ++type) {
+            pickups[type] += result.pickups[type];
+        }
+    }
+    std::sort(scores.begin(), scores.end());
+    std::sort(ticks.begin(), ticks.end());
+    
+    stats.scoreMean = scoreSum / games;
+    stats.scoreStddev = std::sqrt(std::max(scoreSquares / games - stats.scoreMean * stats.scoreMean, 0.0));
+    stats.scoreMin = scores.front();
+    stats.scoreP10 = percentile(scores, 10);
+    stats.scoreP50 = percentile(scores, 50);
+    stats.scoreP90 = percentile(scores, 90);
+    stats.scoreMax = scores.back();
+    stats.survivalMean = static_cast<double>(tickSum) / games / TICK_RATE;
+    stats.survivalP50 = static_cast<double>(percentile(ticks, 50)) / TICK_RATE;
+    double minutes = static_cast<double>(tickSum) / TICK_RATE / 60.0;
+    for (int type = 0; type < BOOST_TYPE_COUNT; ++type) {
+        stats.pickupsPerMinute[type] = minutes > 0.0 ? pickups[type] / minutes : 0.0;
+    }
+    return stats;
+}
+
+// Все забеги всех конфигураций идут одной пачкой задач через пул: забеги разной
+// длины перераспределяются между потоками, а у каждого потока свой GameWorld,
+// созданный в этом же потоке и переиспользуемый от забега к забегу.
+inline BatchReport runBatch(const BatchJob& job, WorkStealingPool& pool) {
+    BatchReport report;
+    report.threads = pool.size();
+    std::size_t games = static_cast<std::size_t>(std::max(job.gamesPerConfig, 0));
+    std::vector<GameResult> results(job.configs.size() * games);
+    
+    std::vector<std::unique_ptr<GameWorld>> worlds(pool.size());
+    auto start = std::chrono::steady_clock::now();
+    pool.run(results.size(), [&](std::size_t index, unsigned worker) {
+        if (!worlds[worker]) {
+            worlds[worker].reset(new GameWorld());
+            worlds[worker]->followerCount = 0; // Спутники не влияют на исход
+        }
+        results[index] = playGame(*worlds[worker], job.configs[index / games], job.policy,
+                                  job.seed + index % games, job.maxTicks);
+    });
+    
+    report.stats.resize(job.configs.size());
+    pool.run(job.configs.size(), [&](std::size_t config, unsigned) {
+        report.stats[config] = summarize(job.configs[config], results.data() + config * games, static_cast<int>(games));
+    });
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    for (const auto& result : results) {
+        report.totalTicks += result.ticks;
+    }
+    return report;
+}
+
+// Отчет: строка на конфигурацию
+inline void writeBatchCsv(std::ostream& out, const BatchReport& report) {
+    out << "obstacle_spawn_ticks,boost_spawn_ticks";
+    for (const char* name : BOOST_NAMES) {
+        out << ",weight_" << name;
+    }
+    out << ",games,deaths,score_mean,score_stddev,score_min,score_p10,score_p50,score_p90,score_max"
+        << ",survival_mean_s,survival_p50_s";
+    for (const char* name : BOOST_NAMES) {
+        out << ",pickups_per_min_" << name;
+    }
+    out << "\n";
+    
+    for (const BatchStats& stats : report.stats) {
+        out << stats.config.obstacleSpawnTicks << "," << stats.config.boostSpawnTicks;
+        for (int weight : stats.config.boostWeights) {
+            out << "," << weight;
+        }
+        out << "," << stats.games << "," << stats.deaths << "," << stats.scoreMean << "," << stats.scoreStddev
+            << "," << stats.scoreMin << "," << stats.scoreP10 << "," << stats.scoreP50 << "," << stats.scoreP90
+            << "," << stats.scoreMax << "," << stats.survivalMean << "," << stats.survivalP50;
+        for (double rate : stats.pickupsPerMinute) {
+            out << "," << rate;
+        }
+        out << "\n";
+    }
+}
+
+inline void writeBatchJson(std::ostream& out, const BatchJob& job, const BatchReport& report) {
+    out << "{\n";
+    out << "  \"policy\": \"" << job.policyName << "\",\n";
+    out << "  \"seed\": " << job.seed << ",\n";
+    out << "  \"games_per_config\": " << job.gamesPerConfig << ",\n";
+    out << "  \"max_ticks\": " << job.maxTicks << ",\n";
+    out << "  \"configs\": [";
+    for (std::size_t i = 0; i < report.stats.size(); ++i) {
+        const BatchStats& stats = report.stats[i];
+        out << (i == 0 ? "\n" : ",\n");
+        out << "    {\"obstacle_spawn_ticks\": " << stats.config.obstacleSpawnTicks
+            << ", \"boost_spawn_ticks\": " << stats.config.boostSpawnTicks << ", \"boost_weights\": {";
+        for (int type = 0; type < BOOST_TYPE_COUNT; ++type) {
+            out << (type == 0 ? "" : ", ") << "\"" << BOOST_NAMES[type] << "\": " << stats.config.boostWeights[type];
+        }
+        out << "},\n";
+        out << "     \"games\": " << stats.games << ", \"deaths\": " << stats.deaths << ",\n";
+        out << "     \"score\": {\"mean\": " << stats.scoreMean << ", \"stddev\": " << stats.scoreStddev
+            << ", \"min\": " << stats.scoreMin << ", \"p10\": " << stats.scoreP10 << ", \"p50\": " << stats.scoreP50
+            << ", \"p90\": " << stats.scoreP90 << ", \"max\": " << stats.scoreMax << "},\n";
+        out << "     \"survival_s\": {\"mean\": " << stats.survivalMean << ", \"p50\": " << stats.survivalP50 << "},\n";
+        out << "     \"pickups_per_min\": {";
+        for (int type = 0; type < BOOST_TYPE_COUNT; ++type) {
+            out << (type == 0 ? "" : ", ") << "\"" << BOOST_NAMES[type] << "\": " << stats.pickupsPerMinute[type];
+        }
+        out << "}}";
+    }
+    out << "\n  ]\n}\n";
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <cmath>
+
+// Прямоугольник в игровых координатах (без зависимости от SFML)
+struct Box {
+    float x = 0.0f;
+    float y = 0.0f;
+    float w = 0.0f;
+    float h = 0.0f;
+    
+    bool intersects(const Box& other) const {
+        return x < other.x + other.w && other.x < x + w &&
+               y < other.y + other.h && other.y < y + h;
+    }
+};
+
+// Прямоугольник, сместившийся за тик на dy по вертикали: положение в начале
+// и в конце тика и вся заметенная им полоса. Задетым считается то, что
+// пересекает конечное положение или проскочено за тик целиком, - пересечение
+// в начале тика уже проверял прошлый тик. Пока шаг меньше размеров, результат
+// тот же, что у проверки одного конечного положения.
+struct SweptBox {
+    Box start;
+    Box end;
+    Box bounds; // Объединение start и end
+    
+    static SweptBox along(const Box& end, float dy) {
+        SweptBox sweep;
+        sweep.end = end;
+        sweep.start = end;
+        sweep.start.y -= dy;
+        sweep.bounds = end;
+        sweep.bounds.y = std::min(end.y, sweep.start.y);
+        sweep.bounds.h = end.h + std::abs(dy);
+        return sweep;
+    }
+    
+    bool hits(const Box& other) const {
+        return end.intersects(other) || (bounds.intersects(other) && !start.intersects(other));
+    }
+};
+
+// Широкая фаза столкновений: сетка "полоса x полоса по высоте".
+// Каждый тик индексы сущностей раскладываются подсчетом по ячейкам, поэтому
+// внутри полосы они идут по возрастанию y с точностью до высоты ячейки.
+// Запрос смотрит только полосы, которые может задеть прямоугольник, и ячейки
+// рядом с ним по y; точная проверка пересечения остается вызывающему.
+// Пока сущностей мало, сетка не строится и запрос просто перебирает всех.
+template <std::size_t Capacity>
+class LaneBroadphase {
+public:
+    static const int LANES = 3;
+    static const int ROWS = 28;
+    static constexpr float TOP = -128.0f;
+    static constexpr float CELL_HEIGHT = 32.0f;
+    static const std::size_t LINEAR_LIMIT = 32;
+
+private:
+    static const int CELLS = LANES * ROWS;
+    
+    std::uint16_t order[Capacity];
+    int cellStart[CELLS + 1] = {};
+    std::size_t count = 0;
+    bool linear = true;
+    float laneLeft = 0.0f;
+    float laneWidth = 1.0f;
+    float maxWidth = 0.0f;
+    float maxHeight = 0.0f;
+    
+    int laneOf(float centerX) const {
+        int lane = static_cast<int>((centerX - laneLeft) / laneWidth);
+        return std::min(std::max(lane, 0), LANES - 1);
+    }
+    
+    static int rowOf(float y) {
+        int row = static_cast<int>((y - TOP) / CELL_HEIGHT);
+        return std::min(std::max(row, 0), ROWS - 1);
+    }
+
+public:
+    static_assert(Capacity <= 65536, "indices are stored as 16 bits");
+    
+    // Сетка - рабочая память одного тика, ее строят заново перед каждым запросом.
+    // Поэтому копия мира сетку не копирует: копия начинает с пустой.
+    LaneBroadphase() = default;
+    
+    LaneBroadphase(const LaneBroadphase&) {}
+    
+    LaneBroadphase& operator=(const LaneBroadphase&) {
+        count = 0;
+        linear = true;
+        return *this;
+    }
+    
+    // Раскладка сущностей по ячейкам (сортировка подсчетом за O(n)).
+    // eachBounds(visit) вызывает visit(Box) для всех сущностей по порядку индексов.
+    template <typename EachBounds>
+    void build(std::size_t entityCount, EachBounds eachBounds, float firstLaneLeft, float width) {
+        count = entityCount;
+        linear = count <= LINEAR_LIMIT;
+        if (linear) {
+            return;
+        }
+        
+        laneLeft = firstLaneLeft;
+        laneWidth = width;
+        maxWidth = 0.0f;
+        maxHeight = 0.0f;
+        
+        std::uint16_t cellOf[Capacity];
+        int counts[CELLS] = {};
+        std::size_t index = 0;
+        eachBounds([&](const Box& bounds) {
+            int cell = laneOf(bounds.x + bounds.w / 2) * ROWS + rowOf(bounds.y);
+            cellOf[index++] = static_cast<std::uint16_t>(cell);
+            counts[cell]++;
+            maxWidth = std::max(maxWidth, bounds.w);
+            maxHeight = std::max(maxHeight, bounds.h);
+        });
+        
+        int start = 0;
+        for (int cell = 0; cell < CELLS; ++cell) {
+            cellStart[cell] = start;
+            start += counts[cell];
+        }
+        cellStart[CELLS] = start;
+        
+        for (std::size_t i = 0; i < count; ++i) {
+            order[--counts[cellOf[i]] + cellStart[cellOf[i]]] = static_cast<std::uint16_t>(i);
+        }
+    }
+    
+    // Обход кандидатов на пересечение с box; visit(index) возвращает true,
+    // чтобы остановить обход. Возвращает true, если обход остановлен.
+    template <typename Visitor>
+    bool query(const Box& box, Visitor visit) const {
+        if (linear) {
+            for (std::size_t i = 0; i < count; ++i) {
+                if (visit(i)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        
+        // Сущности полосы лежат по центру полосы не шире maxWidth
+        int firstLane = LANES;
+        int lastLane = -1;
+        for (int lane = 0; lane < LANES; ++lane) {
+            float center = laneLeft + laneWidth * (lane + 0.5f);
+            if (center - maxWidth / 2 < box.x + box.w && box.x < center + maxWidth / 2) {
+                firstLane = std::min(firstLane, lane);
+                lastLane = lane;
+            }
+        }
+        
+        // Верх сущности лежит в ее ячейке, поэтому сверху нужен запас maxHeight
+        int firstRow = rowOf(box.y - maxHeight);
+        int lastRow = rowOf(box.y + box.h);
+        for (int lane = firstLane; lane <= lastLane; ++lane) {
+            int begin = cellStart[lane * ROWS + firstRow];
+            int end = cellStart[lane * ROWS + lastRow + 1];
+            for (int k = begin; k < end; ++k) {
+                if (visit(static_cast<std::size_t>(order[k]))) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+};
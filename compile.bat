@@ -2,7 +2,12 @@
 chcp 65001
 echo Compilation...
 
+rem compile.bat profile - сборка с профилировщиком (F3 - оверлей, F4 - трасса)
+set DEFINES=
+if "%1"=="profile" set DEFINES=-DRR_PROFILE
+
 g++ main.cpp -o game.exe ^
+-std=c++17 -O2 %DEFINES% ^
 -ISFML-3.0.2/include ^
 -LSFML-3.0.2/lib ^
 -lsfml-graphics ^
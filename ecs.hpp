@@ -0,0 +1,242 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <algorithm>
+
+// Небольшая ECS с хранением по архетипам.
+// Архетип - это фиксированный набор компонентов. Его сущности лежат в чанках
+// по CHUNK_SIZE штук, а внутри чанка каждый компонент - отдельный непрерывный
+// массив, так что система читает подряд только нужные ей компоненты.
+// Набор архетипов известен при компиляции, вся память выделена заранее внутри
+// объекта: нет выделений при спавне, а мир копируется обычным присваиванием.
+// Копируются только живые сущности, так что копия почти пустого архетипа
+// дешевая, сколько бы ни было заранее выделено.
+// Сущность адресуется архетипом и индексом; удаление переставляет последнюю
+// сущность архетипа на место удаленной, поэтому индексы не стабильны.
+
+const std::size_t ECS_CHUNK_SIZE = 256;
+
+template <typename T, typename... List>
+struct ContainsType : std::disjunction<std::is_same<T, List>...> {};
+
+template <std::size_t Capacity, typename... Components>
+class Archetype {
+public:
+    static const std::size_t CAPACITY = Capacity;
+    static const std::size_t CHUNK_SIZE = Capacity < ECS_CHUNK_SIZE ? Capacity : ECS_CHUNK_SIZE;
+    static const std::size_t CHUNK_COUNT = (Capacity + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    
+    // Есть ли в архетипе все перечисленные компоненты
+    template <typename... Required>
+    static constexpr bool has() {
+        return (ContainsType<Required, Components...>::value && ...);
+    }
+
+private:
+    template <typename Component>
+    struct Column {
+        Component values[CHUNK_SIZE];
+    };
+    
+    struct Chunk : Column<Components>... {};
+    
+    Chunk chunks[CHUNK_COUNT];
+    std::size_t count = 0;
+    
+    template <typename Component>
+    Component* column(std::size_t chunk) {
+        return static_cast<Column<Component>&>(chunks[chunk]).values;
+    }
+    
+    template <typename Component>
+    const Component* column(std::size_t chunk) const {
+        return static_cast<const Column<Component>&>(chunks[chunk]).values;
+    }
+
+public:
+    Archetype() = default;
+    
+    Archetype(const Archetype& other) {
+        *this = other;
+    }
+    
+    Archetype& operator=(const Archetype& other) {
+        count = other.count;
+        for (std::size_t chunk = 0; chunk < chunkCount(); ++chunk) {
+            std::size_t n = chunkSize(chunk);
+            ((std::copy_n(other.column<Components>(chunk), n, column<Components>(chunk))), ...);
+        }
+        return *this;
+    }
+    
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == Capacity; }
+    
+    void clear() {
+        count = 0;
+    }
+    
+    // Возвращает false, если архетип заполнен
+    bool add(const Components&... values) {
+        if (count == Capacity) {
+            return false;
+        }
+        ((get<Components>(count) = values), ...);
+        count++;
+        return true;
+    }
+    
+    void remove(std::size_t index) {
+        count--;
+        if (index != count) {
+            ((get<Components>(index) = get<Components>(count)), ...);
+        }
+    }
+    
+    template <typename Component>
+    Component& get(std::size_t index) {
+        return column<Component>(index / CHUNK_SIZE)[index % CHUNK_SIZE];
+    }
+    
+    template <typename Component>
+    const Component& get(std::size_t index) const {
+        return column<Component>(index / CHUNK_SIZE)[index % CHUNK_SIZE];
+    }
+    
+    // Непрерывный массив компонента в чанке - для систем, которые обходят его сами
+    std::size_t chunkCount() const { return (count + CHUNK_SIZE - 1) / CHUNK_SIZE; }
+    std::size_t chunkSize(std::size_t chunk) const {
+        return chunk + 1 < chunkCount() ? CHUNK_SIZE : count - chunk * CHUNK_SIZE;
+    }
+    
+    template <typename Component>
+    Component* chunkData(std::size_t chunk) {
+        return column<Component>(chunk);
+    }
+    
+    // fn(Required&...) для каждой сущности, чанк за чанком
+    template <typename... Required, typename Fn>
+    void each(Fn&& fn) {
+        for (std::size_t chunk = 0; chunk < chunkCount(); ++chunk) {
+            std::size_t n = chunkSize(chunk);
+            for (std::size_t i = 0; i < n; ++i) {
+                fn(column<Required>(chunk)[i]...);
+            }
+        }
+    }
+    
+    template <typename... Required, typename Fn>
+    void each(Fn&& fn) const {
+        for (std::size_t chunk = 0; chunk < chunkCount(); ++chunk) {
+            std::size_t n = chunkSize(chunk);
+            for (std::size_t i = 0; i < n; ++i) {
+                fn(column<Required>(chunk)[i]...);
+            }
+        }
+    }
+    
+    // Побайтовый обход живых сущностей для сохранения и восстановления:
+    // archive.value(count), затем массивы компонентов по чанкам. Self - const
+    // архетип при записи и обычный при чтении, код обхода один.
+    template <typename Self, typename Archive>
+    static void transfer(Self& self, Archive& archive) {
+        archive.value(self.count);
+        for (std::size_t chunk = 0; chunk < self.chunkCount(); ++chunk) {
+            std::size_t n = self.chunkSize(chunk);
+            (archive.array(self.template column<Components>(chunk), n), ...);
+        }
+    }
+    
+    // Удаление сущностей, для которых pred(Required&...) истинно.
+    // Обход с конца: переставленная на место удаленной сущность уже проверена.
+    template <typename... Required, typename Pred>
+    void removeIf(Pred&& pred) {
+        for (std::size_t chunk = chunkCount(); chunk-- > 0;) {
+            for (std::size_t i = chunkSize(chunk); i-- > 0;) {
+                if (pred(column<Required>(chunk)[i]...)) {
+                    remove(chunk * CHUNK_SIZE + i);
+                }
+            }
+        }
+    }
+};
+
+// Все архетипы мира. Системы обходят компоненты сразу во всех архетипах,
+// где они есть, поэтому новый вид сущности - это новый архетип в списке,
+// а не новые поля и циклы.
+template <typename... Archetypes>
+class Registry {
+private:
+    template <typename A>
+    struct Slot {
+        A archetype;
+    };
+    
+    struct Storage : Slot<Archetypes>... {};
+    
+    Storage storage;
+
+public:
+    template <typename A>
+    A& get() {
+        return static_cast<Slot<A>&>(storage).archetype;
+    }
+    
+    template <typename A>
+    const A& get() const {
+        return static_cast<const Slot<A>&>(storage).archetype;
+    }
+    
+    void clear() {
+        (get<Archetypes>().clear(), ...);
+    }
+    
+    // Все архетипы по порядку списка (см. Archetype::transfer)
+    template <typename Self, typename Archive>
+    static void transfer(Self& self, Archive& archive) {
+        (Archetypes::transfer(self.template get<Archetypes>(), archive), ...);
+    }
+    
+    // fn(Required&...) для каждой сущности с этими компонентами
+    template <typename... Required, typename Fn>
+    void each(Fn&& fn) {
+        eachArchetype<Required...>([&fn](auto& archetype) {
+            archetype.template each<Required...>(fn);
+        });
+    }
+    
+    template <typename... Required, typename Fn>
+    void each(Fn&& fn) const {
+        eachArchetype<Required...>([&fn](const auto& archetype) {
+            archetype.template each<Required...>(fn);
+        });
+    }
+    
+    // fn(archetype&) для каждого архетипа с этими компонентами
+    template <typename... Required, typename Fn>
+    void eachArchetype(Fn&& fn) {
+        (visitIf<Archetypes, Required...>(fn), ...);
+    }
+    
+    template <typename... Required, typename Fn>
+    void eachArchetype(Fn&& fn) const {
+        (visitIf<Archetypes, Required...>(fn), ...);
+    }
+
+private:
+    template <typename A, typename... Required, typename Fn>
+    void visitIf(Fn& fn) {
+        if constexpr (A::template has<Required...>()) {
+            fn(get<A>());
+        }
+    }
+    
+    template <typename A, typename... Required, typename Fn>
+    void visitIf(Fn& fn) const {
+        if constexpr (A::template has<Required...>()) {
+            fn(get<A>());
+        }
+    }
+};
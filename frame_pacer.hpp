@@ -0,0 +1,106 @@
+#pragma once
+
+#include <SFML/System.hpp>
+#include <chrono>
+#include <thread>
+#include <cmath>
+#include <algorithm>
+
+// Статистика темпа кадров
+struct FramePacingStats {
+    long long frames = 0;
+    long long missed = 0;
+    double worstLateMs = 0.0;
+    double totalLateMs = 0.0;
+};
+
+// Ограничение частоты кадров.
+// Ожидание гибридное: пока до срока далеко, поток спит короткими отрезками,
+// последние доли миллисекунды докручиваются в цикле по steady_clock.
+// Длительность сна оценивается по прошлым замерам (среднее + разброс), так что
+// неточный сон не приводит к опозданиям. Спит sf::sleep: на Windows он на время
+// сна поднимает точность системного таймера до 1 мс (иначе sleep_for(1ms) длится
+// ~15.6 мс, оценка превышает период кадра и все ожидание уходит в цикл).
+// Если таймер все же грубее периода, ожидание честно крутится в цикле.
+class FramePacer {
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    Clock::duration period{0};
+    Clock::time_point deadline;
+    bool started = false;
+    FramePacingStats stats;
+    
+    // Оценка длительности одного sf::sleep(1ms) в секундах
+    double sleepEstimate = 0.002;
+    double sleepMean = 0.002;
+    double sleepM2 = 0.0;
+    long long sleepCount = 1;
+    
+    void sleepUntil(Clock::time_point target) {
+        for (;;) {
+            double remaining = std::chrono::duration<double>(target - Clock::now()).count();
+            if (remaining <= sleepEstimate) {
+                break;
+            }
+            auto start = Clock::now();
+            sf::sleep(sf::milliseconds(1));
+            double observed = std::chrono::duration<double>(Clock::now() - start).count();
+            
+            // Алгоритм Уэлфорда для среднего и дисперсии
+            sleepCount++;
+            double delta = observed - sleepMean;
+            sleepMean += delta / sleepCount;
+            sleepM2 += delta * (observed - sleepMean);
+            sleepEstimate = sleepMean + std::sqrt(sleepM2 / (sleepCount - 1));
+        }
+        while (Clock::now() < target) {
+            std::this_thread::yield();
+        }
+    }
+
+public:
+    // 0 - без ограничения
+    void setTargetFps(int fps) {
+        period = fps > 0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps))
+                         : Clock::duration(0);
+        started = false;
+    }
+    
+    bool isLimited() const { return period.count() > 0; }
+    
+    // Начать отсчет заново (после паузы, экранов меню и т.п.)
+    void reset() {
+        started = false;
+    }
+    
+    // Вызывается после display(): ждет срока следующего кадра
+    void wait() {
+        auto now = Clock::now();
+        if (!started) {
+            deadline = now;
+            started = true;
+        }
+        stats.frames++;
+        if (!isLimited()) {
+            return;
+        }
+        
+        deadline += period;
+        if (now > deadline) {
+            double lateMs = std::chrono::duration<double, std::milli>(now - deadline).count();
+            stats.missed++;
+            stats.totalLateMs += lateMs;
+            stats.worstLateMs = std::max(stats.worstLateMs, lateMs);
+            
+            // Сильно отстали: не догоняем пачкой кадров, а начинаем с текущего момента
+            if (now - deadline > period) {
+                deadline = now;
+            }
+            return;
+        }
+        sleepUntil(deadline);
+    }
+    
+    const FramePacingStats& getStats() const { return stats; }
+};
@@ -0,0 +1,955 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <functional>
+#include <chrono>
+#include <cfloat>
+#include "ecs.hpp"
+#include "broadphase.hpp"
+#include "profiler.hpp"
+#include "timer_wheel.hpp"
+#include "history_ring.hpp"
+#include "simulation.hpp"
+#include "track_generator.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RR_SSE2 1
+#endif
+
+// FNV-1a для хэша состояния
+inline void hashBytes(std::uint64_t& hash, const void* data, std::size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+template <typename T>
+void hashValue(std::uint64_t& hash, const T& value) {
+    unsigned char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    hashBytes(hash, bytes, sizeof(T));
+}
+
+// Команды игрока, которые раньше напрямую обрабатывал handleGameInput
+enum class Command { LANE_LEFT, LANE_RIGHT, JUMP, MOPED };
+
+// Бусты
+enum BoostType { BEER, RUBLE, ENERGY, SEEDS, MACASIN, MOPED, BOOST_TYPE_COUNT };
+
+// События колеса таймеров: окончания бустов, кадры анимаций, спавн
+enum TimerEvent {
+    ENERGY_END, SEEDS_END, MACASIN_END, MOPED_END, MOPED_COOLDOWN_END, // Отсчеты бустов (см. legacyTiming)
+    ANIMATION_FRAME, MOPED_RIDE_FRAME,
+    SCORE_TICK, SPAWN_OBSTACLE, SPAWN_BOOST,
+    TIMER_EVENT_COUNT
+};
+const int BOOST_TIMER_COUNT = MOPED_COOLDOWN_END + 1;
+
+// Компоненты сущностей мира
+struct Position {
+    float x = 0.0f; // Левый верхний угол
+    float y = 0.0f;
+};
+
+struct Extent {
+    float w = 0.0f;
+    float h = 0.0f;
+};
+
+struct Obstacle {
+    int type = 0; // 0 - лавка, 1 - гараж
+};
+
+struct Boost {
+    int type = 0; // BoostType
+};
+
+// Бегущий по полосам персонаж: рисуется на высоте baseY минус высота прыжка
+struct Runner {
+    float baseY = 0.0f;
+};
+
+struct Lane {
+    int lane = 1;
+};
+
+struct Jump {
+    float height = 0.0f;
+    float prevHeight = 0.0f; // Высота на прошлом тике, для интерполяции
+    bool rising = false;
+    bool falling = false;
+};
+
+struct Animation {
+    int frame = 0;
+    int frameCount = 0; // 0 - анимация не крутится
+};
+
+// Повторяет путь игрока с отставанием на delayTicks тиков
+struct Follow {
+    int delayTicks = 0;
+};
+
+// Состояние игрока за один тик, из них складывается история для спутников
+struct RunnerSample {
+    float height = 0.0f;
+    int lane = 1;
+};
+
+// Симуляция забега без окна: вся игровая логика, которую рисует RussiaRunner
+class GameWorld {
+public:
+    // Емкость архетипов препятствий и бустов
+    static const std::size_t MAX_OBSTACLES = 4096;
+    static const std::size_t MAX_BOOSTS = 1024;
+    
+    // Колонна спутников: каждый следующий отстает еще на FOLLOWER_STEP_TICKS
+    // и стоит чуть ниже, вся колонна укладывается в FOLLOWER_DEPTH пикселей
+    static const std::size_t MAX_FOLLOWERS = 512;
+    static const int FOLLOWER_DELAY_TICKS = TICK_RATE * 3 / 20; // Задержка 0.15 секунды
+    static const int FOLLOWER_STEP_TICKS = 6;
+    static constexpr float FOLLOWER_DEPTH = 30.0f;
+    static const std::size_t HISTORY_TICKS = 4096;
+    static_assert(FOLLOWER_DELAY_TICKS + (MAX_FOLLOWERS - 1) * FOLLOWER_STEP_TICKS < HISTORY_TICKS,
+                  "player history must cover the last follower");
+    
+    // Архетипы: игрок и спутник отличаются только компонентом Follow
+    using PlayerArchetype = Archetype<1, Runner, Lane, Jump, Animation>;
+    using FollowerArchetype = Archetype<MAX_FOLLOWERS, Runner, Lane, Jump, Animation, Follow>;
+    using ObstacleArchetype = Archetype<MAX_OBSTACLES, Position, Extent, Obstacle>;
+    using BoostArchetype = Archetype<MAX_BOOSTS, Position, Extent, Boost>;
+    using Entities = Registry<PlayerArchetype, FollowerArchetype, ObstacleArchetype, BoostArchetype>;
+    using History = HistoryRing<RunnerSample, HISTORY_TICKS>;
+    
+    // Логическое поле: координаты мира не зависят от размера окна,
+    // окно показывает это поле целиком через свой вид
+    static constexpr float FIELD_WIDTH = 600.0f;
+    static constexpr float FIELD_HEIGHT = 600.0f;
+    
+    static constexpr float PLAYER_Y = FIELD_HEIGHT - 100.0f;
+    static_assert(PLAYER_Y == TRACK_PLAYER_Y, "track solvability is checked for this runner");
+    static constexpr float FOLLOWER_Y = FIELD_HEIGHT - 40.0f;
+    
+    // Сущности ниже этой границы (за нижним краем поля) удаляются
+    static constexpr float CULL_Y = FIELD_HEIGHT + 50.0f;
+    
+    // Длительности в тиках
+    static const int FRAME_TICKS = TICK_RATE / 10; // 0.1 секунды на кадр анимации
+    static const int OBSTACLE_SPAWN_TICKS = TICK_RATE * 4 / 5; // 0.8 секунды
+    static const int BOOST_SPAWN_TICKS = TICK_RATE * 5; // 5 секунд
+    static const int ENERGY_TICKS = TICK_RATE * 15;
+    static const int SEEDS_TICKS = TICK_RATE * 15;
+    static const int MACASIN_TICKS = TICK_RATE * 15;
+    static const int MOPED_TICKS = TICK_RATE * 20;
+    static const int MOPED_COOLDOWN_TICKS = TICK_RATE; // Задержка после поломки мопеда
+    
+    // Размеры поля и полосы
+    float fieldWidth = FIELD_WIDTH;
+    float laneWidth = 150.0f;
+    float lanePositions[3] = {};
+    
+    // Размер хитбокса игрока (фронтенд подставляет размер спрайта)
+    float playerWidth = 50.0f;
+    float playerHeight = 50.0f;
+    float mopedWidth = 50.0f;
+    float mopedHeight = 50.0f;
+    
+    // Число кадров анимаций (0 - анимация не крутится)
+    int runFrameCount = 4;
+    int followerFrameCount = 3;
+    int mopedRideFrameCount = 4;
+    
+    // Высота тайла дороги для зацикливания смещения
+    float roadTileHeight = 0.0f;
+    
+    // Анимация мопеда (кадры бега - в компоненте Animation игрока)
+    int mopedRideFrame = 0;
+    
+    // Дорога
+    float roadOffset = 0.0f;
+    float prevRoadOffset = 0.0f;
+    float roadSpeed = 300.0f;
+    float baseRoadSpeed = 300.0f;
+    
+    // Прыжок (общий для всех бегущих)
+    float jumpSpeed = 400.0f;
+    float maxJumpHeight = 150.0f;
+    
+    // Все сущности: игрок, спутник, препятствия и бусты.
+    // Подобранные бусты и ушедшие за экран сущности сразу удаляются.
+    Entities entities;
+    
+    // Состояния игрока за последние HISTORY_TICKS тиков (последнее - текущий тик)
+    History playerHistory;
+    float obstacleSpeed = 300.0f;
+    float lastScrollStep = 0.0f; // Сдвиг препятствий и бустов за последний тик
+    
+    // Широкая фаза столкновений, перестраивается в checkCollisions
+    LaneBroadphase<MAX_OBSTACLES> obstacleGrid;
+    LaneBroadphase<MAX_BOOSTS> boostGrid;
+    
+    // Активные бусты (сколько им осталось - в таймерах, см. timeLeft)
+    bool hasEnergyBoost = false;
+    bool hasSeedsBoost = false;
+    bool hasMacasinBoost = false;
+    
+    // Мопед
+    int mopedCount = 1;
+    bool isMopedActive = false;
+    static const int MAX_MOPEDS = 3;
+    
+    // Счет
+    int score = 0;
+    int scoreMultiplier = 1;
+    
+    // Все отсчеты времени забега
+    TimerWheel<TIMER_EVENT_COUNT> timers;
+    
+    // Отсчеты бустов в секундах для legacyTiming (вместо таймеров ENERGY_END .. MOPED_COOLDOWN_END)
+    float legacyTimeLeft[BOOST_TIMER_COUNT] = {};
+    
+    // Нагрузочный режим: множитель частоты спавна и лимита бустов, бессмертие.
+    // Это настройки, а не состояние забега, поэтому reset их не трогает.
+    int spawnRate = 1;
+    bool invulnerable = false;
+    
+    // Число спутников в колонне (от 0 до MAX_FOLLOWERS), применяется в reset
+    int followerCount = 1;
+    
+    // Баланс для пакетных прогонов: периоды спавна в тиках и веса типов бустов.
+    // Тоже настройки; значения по умолчанию - обычная игра (все бусты равновероятны).
+    // С генератором трассы obstacleSpawnTicks задает расстояние между рядами препятствий.
+    int obstacleSpawnTicks = OBSTACLE_SPAWN_TICKS;
+    int boostSpawnTicks = BOOST_SPAWN_TICKS;
+    int boostWeights[BOOST_TYPE_COUNT] = {1, 1, 1, 1, 1, 1};
+    
+    // Препятствия из кусков трассы (см. track_generator.hpp); false - прежний
+    // спавн по таймеру, для повторов первой версии. В нагрузочном режиме
+    // (spawnRate > 1) препятствия всегда идут по таймеру.
+    bool generatedTrack = true;
+    // Отсчеты бустов как до колеса таймеров, для повторов первой версии:
+    // секунды уменьшаются на TICK_DT после движения препятствий, а буст
+    // кончается, когда остаток дойдет до нуля. Из-за накопления ошибки float
+    // это бывает на тик позже, чем по колесу, и забег идет иначе.
+    bool legacyTiming = false;
+    // Откуда брать готовые куски; nullptr - строить на месте. Общий для копий
+    // мира, поэтому копии шагают только в том же потоке, что и оригинал.
+    TrackFeed* trackFeed = nullptr;
+    
+    // Трасса: пройденный дорогой путь, текущий кусок и следующее препятствие в нем
+    double trackDistance = 0.0;
+    TrackChunk trackChunk;
+    int trackNext = 0;
+    
+    // Статистика забега: подобрано бустов каждого типа (в хэш не входит)
+    int boostPickups[BOOST_TYPE_COUNT] = {};
+    
+    // Замер времени checkCollisions (только для нагрузочного режима)
+    bool timeCollisions = false;
+    double collisionSeconds = 0.0;
+    
+#ifdef RR_PROFILE
+    // Зоны профилировщика пишет только мир, который видит игрок; копии
+    // (автопилот, перемотка) и миры пакетов и проверок - нет
+    ProfileSwitch profiled;
+#endif
+    
+    // Seed и номер тика текущего забега
+    std::uint64_t seed = 0;
+    Rng rng;
+    long long tick = 0;
+    
+    bool gameOver = false;
+    
+    explicit GameWorld(float width = FIELD_WIDTH) {
+        setFieldWidth(width);
+        reset(0);
+    }
+    
+    // Инициализация дорожных полос: три полосы занимают три четверти ширины по центру
+    void setFieldWidth(float width) {
+        fieldWidth = width;
+        laneWidth = width / 4.0f;
+        float offset = (width - (laneWidth * 3)) / 2.0f;
+        lanePositions[0] = offset;
+        lanePositions[1] = offset + laneWidth;
+        lanePositions[2] = offset + laneWidth * 2;
+    }
+    
+    ObstacleArchetype& obstacles() { return entities.get<ObstacleArchetype>(); }
+    const ObstacleArchetype& obstacles() const { return entities.get<ObstacleArchetype>(); }
+    BoostArchetype& boosts() { return entities.get<BoostArchetype>(); }
+    const BoostArchetype& boosts() const { return entities.get<BoostArchetype>(); }
+    const FollowerArchetype& followers() const { return entities.get<FollowerArchetype>(); }
+    
+    // Компонент игрока (он в мире всегда один)
+    template <typename Component>
+    Component& player() { return entities.get<PlayerArchetype>().get<Component>(0); }
+    template <typename Component>
+    const Component& player() const { return entities.get<PlayerArchetype>().get<Component>(0); }
+    
+    // Положение бегущего персонажа (отрисовка между тиками - в RenderSnapshot)
+    float runnerX(const Lane& lane) const { return lanePositions[lane.lane] + laneWidth/2 - 25; }
+    float runnerY(const Runner& runner, const Jump& jump) const { return runner.baseY - jump.height; }
+    
+    float playerX() const { return runnerX(player<Lane>()); }
+    float playerY() const { return runnerY(player<Runner>(), player<Jump>()); }
+    
+    template <typename Bodies>
+    static Box bodyBounds(const Bodies& bodies, std::size_t i) {
+        const Position& position = bodies.template get<Position>(i);
+        const Extent& extent = bodies.template get<Extent>(i);
+        return {position.x, position.y, extent.w, extent.h};
+    }
+    Box obstacleBounds(std::size_t i) const { return bodyBounds(obstacles(), i); }
+    
+    // Обход прямоугольников архетипа по порядку индексов (для построения сетки)
+    template <typename Bodies>
+    static auto eachBodyBounds(const Bodies& bodies) {
+        return [&bodies](auto&& visit) {
+            bodies.template each<Position, Extent>([&visit](const Position& position, const Extent& extent) {
+                visit(Box{position.x, position.y, extent.w, extent.h});
+            });
+        };
+    }
+    Box boostBounds(std::size_t i) const { return bodyBounds(boosts(), i); }
+    
+    // Оставшееся время таймера в секундах (для HUD и мигания)
+    float timeLeft(TimerEvent event) const {
+        if (legacyTiming && event < BOOST_TIMER_COUNT) {
+            return std::max(legacyTimeLeft[event], 0.0f);
+        }
+        return static_cast<float>(timers.remaining(event)) * TICK_DT;
+    }
+    
+    bool isMopedCoolingDown() const {
+        if (legacyTiming) {
+            return legacyTimeLeft[MOPED_COOLDOWN_END] > 0.0f;
+        }
+        return timers.isScheduled(MOPED_COOLDOWN_END);
+    }
+    
+    Box playerBounds() const {
+        if (isMopedActive) {
+            return {playerX(), playerY(), mopedWidth, mopedHeight};
+        }
+        return {playerX(), playerY(), playerWidth, playerHeight};
+    }
+    
+    // Сброс игры с новым seed
+    void reset(std::uint64_t runSeed) {
+        seed = runSeed;
+        rng.seed(runSeed);
+        tick = 0;
+        
+        entities.clear();
+        entities.get<PlayerArchetype>().add(Runner{PLAYER_Y}, Lane{}, Jump{}, Animation{0, runFrameCount});
+        int followers = std::min(std::max(followerCount, 0), static_cast<int>(MAX_FOLLOWERS));
+        playerHistory.fill(RunnerSample{}, followers > 0 ? FOLLOWER_DELAY_TICKS + (followers - 1) * FOLLOWER_STEP_TICKS + 1 : 1);
+        for (int i = 0; i < followers; ++i) {
+            float baseY = FOLLOWER_Y + (followers > 1 ? FOLLOWER_DEPTH * i / (followers - 1) : 0.0f);
+            int firstFrame = followerFrameCount > 0 ? i % followerFrameCount : 0;
+            entities.get<FollowerArchetype>().add(Runner{baseY}, Lane{}, Jump{}, Animation{firstFrame, followerFrameCount},
+                                                  Follow{FOLLOWER_DELAY_TICKS + i * FOLLOWER_STEP_TICKS});
+        }
+        score = 0;
+        scoreMultiplier = 1;
+        roadOffset = 0.0f;
+        prevRoadOffset = 0.0f;
+        roadSpeed = baseRoadSpeed;
+        obstacleSpeed = 300.0f;
+        
+        hasEnergyBoost = false;
+        hasSeedsBoost = false;
+        hasMacasinBoost = false;
+        
+        mopedCount = 1;
+        isMopedActive = false;
+        mopedRideFrame = 0;
+        std::fill(legacyTimeLeft, legacyTimeLeft + BOOST_TIMER_COUNT, 0.0f);
+        std::fill(boostPickups, boostPickups + BOOST_TYPE_COUNT, 0);
+        
+        lastScrollStep = 0.0f;
+        gameOver = false;
+        
+        trackDistance = 0.0;
+        trackNext = 0;
+        if (usesTrack()) {
+            loadTrackChunk(0);
+        } else {
+            trackChunk = TrackChunk();
+        }
+        
+        // Постоянные таймеры: анимации, спутник, счет и спавн
+        timers.clear(tick);
+        timers.schedule(ANIMATION_FRAME, FRAME_TICKS);
+        timers.schedule(SCORE_TICK, TICK_RATE);
+        if (!usesTrack()) {
+            timers.schedule(SPAWN_OBSTACLE, obstacleSpawnInterval());
+        }
+        timers.schedule(SPAWN_BOOST, boostSpawnInterval());
+    }
+    
+    // Состояние забега для перемотки: ровно то, что задает reset, без настроек
+    // и рабочей памяти. Сначала поля постоянного размера, в конце сущности,
+    // чтобы соседние тики совпадали побайтово как можно дольше (см. RewindBuffer).
+    // Self - const мир при записи и обычный при чтении.
+    template <typename Self, typename Archive>
+    static void transferState(Self& world, Archive& archive) {
+        archive.value(world.seed);
+        archive.value(world.rng);
+        archive.value(world.tick);
+        archive.value(world.gameOver);
+        archive.value(world.score);
+        archive.value(world.scoreMultiplier);
+        archive.value(world.roadOffset);
+        archive.value(world.prevRoadOffset);
+        archive.value(world.roadSpeed);
+        archive.value(world.obstacleSpeed);
+        archive.value(world.lastScrollStep);
+        archive.value(world.hasEnergyBoost);
+        archive.value(world.hasSeedsBoost);
+        archive.value(world.hasMacasinBoost);
+        archive.value(world.mopedCount);
+        archive.value(world.isMopedActive);
+        archive.value(world.mopedRideFrame);
+        archive.array(world.boostPickups, BOOST_TYPE_COUNT);
+        archive.value(world.timers);
+        archive.array(world.legacyTimeLeft, BOOST_TIMER_COUNT);
+        archive.value(world.trackDistance);
+        archive.value(world.trackNext);
+        archive.value(world.trackChunk);
+        History::transfer(world.playerHistory, archive);
+        Entities::transfer(world.entities, archive);
+    }
+    
+    // Хэш итогового состояния забега для проверки повторов.
+    // Сущности складываются коммутативно, поэтому порядок хранения не важен.
+    std::uint64_t stateHash() const {
+        std::uint64_t hash = 1469598103934665603ull;
+        hashValue(hash, tick);
+        hashValue(hash, score);
+        hashValue(hash, scoreMultiplier);
+        hashValue(hash, player<Lane>().lane);
+        hashValue(hash, player<Jump>().height);
+        hashValue(hash, mopedCount);
+        hashValue(hash, isMopedActive);
+        hashValue(hash, gameOver);
+        hashValue(hash, rng.state);
+        
+        std::uint64_t bodies = 0;
+        entities.each<Obstacle, Position>([&bodies](const Obstacle& obstacle, const Position& position) {
+            std::uint64_t entity = 1469598103934665603ull;
+            hashValue(entity, obstacle.type);
+            hashValue(entity, position.x);
+            hashValue(entity, position.y);
+            bodies += entity * 0x9E3779B97F4A7C15ull;
+        });
+        entities.each<Boost, Position>([&bodies](const Boost& boost, const Position& position) {
+            std::uint64_t entity = 1099511628211ull;
+            hashValue(entity, boost.type);
+            hashValue(entity, position.x);
+            hashValue(entity, position.y);
+            bodies += entity * 0xC2B2AE3D27D4EB4Full;
+        });
+        hashValue(hash, bodies);
+        return hash;
+    }
+    
+    // Применение команды игрока
+    void applyCommand(Command command) {
+        if (gameOver) {
+            return;
+        }
+        
+        Lane& lane = player<Lane>();
+        Jump& jump = player<Jump>();
+        switch (command) {
+            case Command::LANE_LEFT:
+                if (lane.lane > 0) {
+                    lane.lane--;
+                }
+                break;
+            
+            case Command::LANE_RIGHT:
+                if (lane.lane < 2) {
+                    lane.lane++;
+                }
+                break;
+            
+            case Command::JUMP:
+                if (!jump.rising && !jump.falling) {
+                    jump.rising = true;
+                    jump.height = 0.0f;
+                }
+                break;
+            
+            case Command::MOPED:
+                if (mopedCount > 0 && !isMopedActive) {
+                    isMopedActive = true;
+                    startBoostTimer(MOPED_END, MOPED_TICKS);
+                    timers.schedule(MOPED_RIDE_FRAME, FRAME_TICKS);
+                    mopedCount--;
+                }
+                break;
+        }
+    }
+    
+    // Один тик симуляции с фиксированным шагом
+    void step() {
+        if (gameOver) {
+            return;
+        }
+        RR_PROFILE_ZONE_IF(profiled, "step");
+        const float deltaTime = TICK_DT;
+        tick++;
+        
+        prevRoadOffset = roadOffset;
+        
+        // Сработавшие таймеры: окончания бустов, кадры анимаций, счет, спавн
+        timers.advance(tick, [this](int event) {
+            onTimer(static_cast<TimerEvent>(event));
+        });
+        
+        // Движение дороги
+        roadOffset += roadSpeed * deltaTime;
+        if (roadTileHeight <= 0.0f) {
+            roadOffset = 0.0f;
+        } else if (roadOffset >= roadTileHeight) {
+            roadOffset -= roadTileHeight;
+        }
+        
+        jumpSystem(deltaTime);
+        playerHistory.push(RunnerSample{player<Jump>().height, player<Lane>().lane});
+        followSystem();
+        bool anyBelow = scrollSystem(deltaTime);
+        if (usesTrack()) {
+            trackSystem();
+        }
+        if (legacyTiming) {
+            legacyTimerSystem(deltaTime);
+        }
+        if (timeCollisions) {
+            auto start = std::chrono::steady_clock::now();
+            checkCollisions();
+            collisionSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } else {
+            checkCollisions();
+        }
+        // Ушедшие за экран удаляются после столкновений: при большом шаге
+        // препятствие может за один тик пройти игрока и уйти за CULL_Y
+        if (anyBelow) {
+            cullSystem();
+        }
+    }
+    
+    // Препятствия идут из кусков трассы, а не по таймеру
+    bool usesTrack() const {
+        return generatedTrack && spawnRate <= 1;
+    }
+
+private:
+    // Периоды спавна с учетом множителя нагрузочного режима
+    int obstacleSpawnInterval() const {
+        return obstacleSpawnTicks / spawnRate + 1;
+    }
+    int boostSpawnInterval() const {
+        return boostSpawnTicks / spawnRate + 1;
+    }
+    
+    // Тип нового буста по весам boostWeights. При равных весах это ровно
+    // rng.nextInt(6), как было до настройки весов, так что старые повторы сходятся.
+    int randomBoostType() {
+        int total = 0;
+        for (int weight : boostWeights) {
+            total += std::max(weight, 0);
+        }
+        if (total <= 0) {
+            return rng.nextInt(BOOST_TYPE_COUNT);
+        }
+        int roll = rng.nextInt(total);
+        int type = 0;
+        while (roll >= std::max(boostWeights[type], 0)) {
+            roll -= std::max(boostWeights[type], 0);
+            type++;
+        }
+        return type;
+    }
+    
+    // Запуск и остановка отсчета буста: в колесе или в секундах для legacyTiming.
+    // Длительности в тиках делятся на TICK_RATE без остатка, так что секунды те же.
+    void startBoostTimer(TimerEvent event, int ticks) {
+        if (legacyTiming) {
+            legacyTimeLeft[event] = static_cast<float>(ticks) / TICK_RATE;
+        } else {
+            timers.schedule(event, ticks);
+        }
+    }
+    
+    void stopBoostTimer(TimerEvent event) {
+        if (legacyTiming) {
+            legacyTimeLeft[event] = 0.0f;
+        } else {
+            timers.cancel(event);
+        }
+    }
+    
+    // Отсчеты бустов для legacyTiming: тот же порядок и та же арифметика float,
+    // что до колеса таймеров; окончание обрабатывает onTimer, как в колесе
+    void legacyTimerSystem(float deltaTime) {
+        float& cooldown = legacyTimeLeft[MOPED_COOLDOWN_END];
+        if (cooldown > 0.0f) {
+            cooldown -= deltaTime;
+            if (cooldown < 0.0f) {
+                cooldown = 0.0f;
+            }
+        }
+        const bool running[] = {hasEnergyBoost, hasSeedsBoost, hasMacasinBoost, isMopedActive};
+        for (int event = ENERGY_END; event <= MOPED_END; ++event) {
+            if (running[event]) {
+                legacyTimeLeft[event] -= deltaTime;
+                if (legacyTimeLeft[event] <= 0.0f) {
+                    onTimer(static_cast<TimerEvent>(event));
+                }
+            }
+        }
+    }
+    
+    // Обработка сработавшего таймера; периодические таймеры перезапускаются здесь
+    void onTimer(TimerEvent event) {
+        switch (event) {
+            case ENERGY_END:
+                hasEnergyBoost = false;
+                roadSpeed = baseRoadSpeed;
+                obstacleSpeed = 300.0f;
+                break;
+            
+            case SEEDS_END:
+                hasSeedsBoost = false;
+                scoreMultiplier = 1;
+                break;
+            
+            case MACASIN_END:
+                hasMacasinBoost = false;
+                break;
+            
+            case MOPED_END:
+                isMopedActive = false;
+                timers.cancel(MOPED_RIDE_FRAME);
+                break;
+            
+            case MOPED_COOLDOWN_END:
+                break;
+            
+            case ANIMATION_FRAME:
+                animationSystem();
+                timers.schedule(ANIMATION_FRAME, FRAME_TICKS);
+                break;
+            
+            case MOPED_RIDE_FRAME:
+                if (mopedRideFrameCount > 0) {
+                    mopedRideFrame = (mopedRideFrame + 1) % mopedRideFrameCount;
+                }
+                timers.schedule(MOPED_RIDE_FRAME, FRAME_TICKS);
+                break;
+            
+            case SCORE_TICK:
+                score += 10 * scoreMultiplier;
+                timers.schedule(SCORE_TICK, TICK_RATE);
+                break;
+            
+            case SPAWN_OBSTACLE:
+                spawnObstacle();
+                timers.schedule(SPAWN_OBSTACLE, obstacleSpawnInterval());
+                break;
+            
+            case SPAWN_BOOST:
+                // При полном лимите бустов попытка повторяется в следующий тик
+                timers.schedule(SPAWN_BOOST, spawnBoost() ? boostSpawnInterval() : 1);
+                break;
+            
+            case TIMER_EVENT_COUNT:
+                break;
+        }
+    }
+    
+    // Системы: каждая обходит свои компоненты во всех архетипах, где они есть
+    
+    // Спутники в точности повторяют путь игрока со своим отставанием: O(1) на спутника.
+    // Идет после jumpSystem, которая уже сохранила их прошлую высоту.
+    void followSystem() {
+        RR_PROFILE_ZONE_IF(profiled, "followSystem");
+        const auto& history = playerHistory;
+        entities.each<Lane, Jump, Follow>([&history](Lane& lane, Jump& jump, const Follow& follow) {
+            const RunnerSample& sample = history.back(static_cast<std::size_t>(follow.delayTicks));
+            lane.lane = sample.lane;
+            jump.height = sample.height;
+        });
+    }
+    
+    // Подъем до maxJumpHeight и спуск с одной скоростью
+    void jumpSystem(float deltaTime) {
+        RR_PROFILE_ZONE_IF(profiled, "jumpSystem");
+        const float step = jumpSpeed * deltaTime;
+        const float top = maxJumpHeight;
+        entities.each<Jump>([step, top](Jump& jump) {
+            jump.prevHeight = jump.height;
+            if (jump.rising) {
+                jump.height += step;
+                if (jump.height >= top) {
+                    jump.rising = false;
+                    jump.falling = true;
+                }
+            }
+            else if (jump.falling) {
+                jump.height -= step;
+                if (jump.height <= 0.0f) {
+                    jump.falling = false;
+                    jump.height = 0.0f;
+                }
+            }
+        });
+    }
+    
+    // Следующий кадр всех анимаций (по таймеру ANIMATION_FRAME)
+    void animationSystem() {
+        entities.each<Animation>([](Animation& animation) {
+            if (animation.frameCount > 0) {
+                animation.frame = (animation.frame + 1) % animation.frameCount;
+            }
+        });
+    }
+    
+    // Движение препятствий и бустов вместе с дорогой; true - кто-то ушел за экран
+    bool scrollSystem(float deltaTime) {
+        RR_PROFILE_ZONE_IF(profiled, "scrollSystem");
+        lastScrollStep = obstacleSpeed * deltaTime;
+        const float step = lastScrollStep;
+        bool anyBelow = false;
+        entities.eachArchetype<Position>([step, &anyBelow](auto& bodies) {
+            anyBelow |= scrollBodies(bodies, step, CULL_Y);
+        });
+        return anyBelow;
+    }
+    
+    // Удаление ушедших за экран; случается редко, поэтому отдельным проходом
+    void cullSystem() {
+        entities.eachArchetype<Position>([](auto& bodies) {
+            bodies.template removeIf<Position>([](const Position& position) {
+                return position.y > CULL_Y;
+            });
+        });
+    }
+    
+    // Сдвиг и проверка границы идут одним проходом по массиву Position каждого чанка
+    template <typename Bodies>
+    static bool scrollBodies(Bodies& bodies, float step, float limit) {
+        static_assert(sizeof(Position) == 2 * sizeof(float), "Position is read as a float array");
+        bool anyBelow = false;
+        for (std::size_t chunk = 0; chunk < bodies.chunkCount(); ++chunk) {
+            Position* positions = bodies.template chunkData<Position>(chunk);
+            std::size_t count = bodies.chunkSize(chunk);
+            std::size_t i = 0;
+#ifdef RR_SSE2
+            // Две сущности за раз: {x0, y0, x1, y1}, x не меняется и не проверяется
+            float* values = &positions[0].x;
+            const __m128 stepVector = _mm_set_ps(step, 0.0f, step, 0.0f);
+            const __m128 limitVector = _mm_set_ps(limit, FLT_MAX, limit, FLT_MAX);
+            int mask = 0;
+            for (; i + 2 <= count; i += 2) {
+                __m128 moved = _mm_add_ps(_mm_loadu_ps(values + 2 * i), stepVector);
+                _mm_storeu_ps(values + 2 * i, moved);
+                mask |= _mm_movemask_ps(_mm_cmpgt_ps(moved, limitVector));
+            }
+            anyBelow |= mask != 0;
+#endif
+            for (; i < count; ++i) {
+                positions[i].y += step;
+                anyBelow |= positions[i].y > limit;
+            }
+        }
+        return anyBelow;
+    }
+    
+    void loadTrackChunk(long long index) {
+        if (trackFeed) {
+            trackChunk = trackFeed->get(seed, index, obstacleSpawnTicks);
+        } else {
+            generateTrackChunk(seed, index, obstacleSpawnTicks, trackChunk);
+        }
+    }
+    
+    // Препятствия трассы, до которых дошла дорога: следующее по готовому куску,
+    // новый кусок - раз в TRACK_CHUNK_LENGTH пикселей. Препятствие ставится
+    // сразу туда, куда бы оно доехало, появись оно ровно в своей точке пути.
+    void trackSystem() {
+        RR_PROFILE_ZONE_IF(profiled, "trackSystem");
+        trackDistance += lastScrollStep;
+        for (;;) {
+            double chunkStart = static_cast<double>(trackChunk.index) * TRACK_CHUNK_LENGTH;
+            if (trackNext == trackChunk.count) {
+                if (trackDistance < chunkStart + TRACK_CHUNK_LENGTH) {
+                    return;
+                }
+                loadTrackChunk(trackChunk.index + 1);
+                trackNext = 0;
+                continue;
+            }
+            const TrackObstacle& next = trackChunk.obstacles[trackNext];
+            double start = chunkStart + next.distance;
+            if (start > trackDistance) {
+                return;
+            }
+            float width = OBSTACLE_WIDTHS[next.type];
+            float height = OBSTACLE_HEIGHTS[next.type];
+            float y = static_cast<float>(trackDistance - start) - height;
+            obstacles().add(Position{lanePositions[next.lane] + laneWidth/2 - width/2, y}, Extent{width, height}, Obstacle{next.type});
+            trackNext++;
+        }
+    }
+    
+    // Создание препятствий по таймеру (без генератора трассы)
+    void spawnObstacle() {
+        RR_PROFILE_ZONE_IF(profiled, "spawnObstacle");
+        // При spawnRate больше периода спавна препятствия идут пачками каждый тик
+        int batch = 1 + spawnRate / (obstacleSpawnTicks + 1);
+        for (int i = 0; i < batch; ++i) {
+            int type = rng.nextInt(2);
+            float width = OBSTACLE_WIDTHS[type];
+            float height = OBSTACLE_HEIGHTS[type];
+            
+            int lane = rng.nextInt(3);
+            obstacles().add(Position{lanePositions[lane] + laneWidth/2 - width/2, -height}, Extent{width, height}, Obstacle{type});
+        }
+    }
+    
+    // Создание бустов; false, если лимит бустов на экране уже достигнут
+    bool spawnBoost() {
+        RR_PROFILE_ZONE_IF(profiled, "spawnBoost");
+        std::size_t maxBoosts = std::min<std::size_t>(3 * static_cast<std::size_t>(spawnRate), MAX_BOOSTS);
+        BoostArchetype& pool = boosts();
+        if (pool.size() >= maxBoosts) {
+            return false;
+        }
+        int batch = 1 + spawnRate / (boostSpawnTicks + 1);
+        for (int i = 0; i < batch && pool.size() < maxBoosts; ++i) {
+            int type = randomBoostType();
+            float size = 40.0f;
+            
+            int lane = rng.nextInt(3);
+            pool.add(Position{lanePositions[lane] + laneWidth/2 - size/2, -size}, Extent{size, size}, Boost{type});
+        }
+        return true;
+    }
+    
+    // Применение эффектов бустов
+    void applyBoostEffect(int boostType) {
+        switch (boostType) {
+            case BEER:
+                score += 100;
+                break;
+            
+            case RUBLE:
+                score += 50;
+                break;
+            
+            case ENERGY:
+                hasEnergyBoost = true;
+                startBoostTimer(ENERGY_END, ENERGY_TICKS);
+                roadSpeed = baseRoadSpeed * 1.2f;
+                obstacleSpeed = 300.0f * 1.2f;
+                break;
+            
+            case SEEDS:
+                hasSeedsBoost = true;
+                startBoostTimer(SEEDS_END, SEEDS_TICKS);
+                scoreMultiplier = 2;
+                break;
+            
+            case MACASIN:
+                hasMacasinBoost = true;
+                startBoostTimer(MACASIN_END, MACASIN_TICKS);
+                break;
+            
+            case MOPED:
+                if (mopedCount < MAX_MOPEDS) {
+                    mopedCount++;
+                }
+                break;
+        }
+    }
+    
+    // Есть ли препятствие (или только гараж), задетое игроком за тик
+    bool hitsObstacle(const SweptBox& sweep, bool garagesOnly) const {
+        return obstacleGrid.query(sweep.bounds, [&](std::size_t i) {
+            return (!garagesOnly || obstacles().get<Obstacle>(i).type == 1) && sweep.hits(obstacleBounds(i));
+        });
+    }
+    
+    // Проверка столкновений по всему пути игрока за тик относительно дороги:
+    // препятствия и бусты сдвинулись на lastScrollStep, игрок - на изменение
+    // высоты прыжка, так что тонкая лавка не проскочит при любом шаге
+    void checkCollisions() {
+        RR_PROFILE_ZONE_IF(profiled, "checkCollisions");
+        const Jump& jump = player<Jump>();
+        SweptBox playerSweep = SweptBox::along(playerBounds(), -(jump.height - jump.prevHeight) - lastScrollStep);
+        
+        // Столкновения с бустами: подобранные удаляются с конца, чтобы не сбить индексы
+        BoostArchetype& pool = boosts();
+        boostGrid.build(pool.size(), eachBodyBounds(pool), lanePositions[0], laneWidth);
+        std::uint16_t picked[MAX_BOOSTS];
+        std::size_t pickedCount = 0;
+        boostGrid.query(playerSweep.bounds, [&](std::size_t i) {
+            if (playerSweep.hits(boostBounds(i))) {
+                picked[pickedCount++] = static_cast<std::uint16_t>(i);
+            }
+            return false;
+        });
+        std::sort(picked, picked + pickedCount, std::greater<std::uint16_t>());
+        for (std::size_t k = 0; k < pickedCount; ++k) {
+            int type = pool.get<Boost>(picked[k]).type;
+            boostPickups[type]++;
+            applyBoostEffect(type);
+            pool.remove(picked[k]);
+        }
+        
+        obstacleGrid.build(obstacles().size(), eachBodyBounds(obstacles()), lanePositions[0], laneWidth);
+        
+        // Мопед активен - проверка на поломку
+        if (isMopedActive) {
+            if (hitsObstacle(playerSweep, false)) {
+                isMopedActive = false;
+                stopBoostTimer(MOPED_END);
+                timers.cancel(MOPED_RIDE_FRAME);
+                startBoostTimer(MOPED_COOLDOWN_END, MOPED_COOLDOWN_TICKS);
+            }
+            return;
+        }
+        
+        // Задержка после поломки мопеда
+        if (isMopedCoolingDown()) {
+            return;
+        }
+        
+        // Макасин активен - логика прыжков
+        if (hasMacasinBoost) {
+            if (jump.rising || jump.falling) {
+                return;
+            }
+            if (hitsObstacle(playerSweep, false)) {
+                gameOver = !invulnerable;
+            }
+            return;
+        }
+        
+        // Обычная логика столкновений: в прыжке опасны только гаражи
+        if (hitsObstacle(playerSweep, jump.rising || jump.falling)) {
+            gameOver = !invulnerable;
+        }
+    }
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+
+// Кольцевой буфер последних Capacity значений: одна запись за тик,
+// чтение значения, записанного age тиков назад, за O(1).
+// Память внутри объекта, так что буфер копируется вместе с миром; копируются
+// только последние depth записей - те, что вообще будут читаться.
+template <typename T, std::size_t Capacity>
+class HistoryRing {
+public:
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+    static const std::size_t CAPACITY = Capacity;
+
+private:
+    T items[Capacity];
+    std::size_t head = 0; // Куда пойдет следующая запись
+    std::size_t depth = Capacity; // Сколько последних записей читается
+
+public:
+    HistoryRing() = default;
+    
+    HistoryRing(const HistoryRing& other) {
+        *this = other;
+    }
+    
+    HistoryRing& operator=(const HistoryRing& other) {
+        head = other.head;
+        depth = other.depth;
+        for (std::size_t age = 0; age < depth; ++age) {
+            std::size_t i = (head - 1 - age) & (Capacity - 1);
+            items[i] = other.items[i];
+        }
+        return *this;
+    }
+    
+    // Вся история заполняется одним значением (например, при старте забега).
+    // readDepth - насколько далеко назад будет читать back, от 1 до Capacity.
+    void fill(const T& value, std::size_t readDepth = Capacity) {
+        for (std::size_t i = 0; i < Capacity; ++i) {
+            items[i] = value;
+        }
+        head = 0;
+        depth = std::min(std::max<std::size_t>(readDepth, 1), Capacity);
+    }
+    
+    void push(const T& value) {
+        items[head] = value;
+        head = (head + 1) & (Capacity - 1);
+    }
+    
+    // Сохранение и восстановление последних depth записей (см. Archetype::transfer).
+    // Длинная история пишется целиком в порядке ячеек: за тик в ней меняется одна
+    // ячейка, и образы соседних тиков почти совпадают побайтово.
+    template <typename Self, typename Archive>
+    static void transfer(Self& self, Archive& archive) {
+        archive.value(self.head);
+        archive.value(self.depth);
+        if (self.depth > Capacity / 64) {
+            archive.array(self.items, Capacity);
+            return;
+        }
+        for (std::size_t age = 0; age < self.depth; ++age) {
+            archive.value(self.items[(self.head - 1 - age) & (Capacity - 1)]);
+        }
+    }
+    
+    // age = 0 - последняя запись; age должен быть меньше depth
+    const T& back(std::size_t age) const {
+        return items[(head - 1 - age) & (Capacity - 1)];
+    }
+};
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <charconv>
+#include <cstring>
+#include "render_snapshot.hpp"
+
+// Поле HUD "подпись + число + окончание".
+// Строка собирается в фиксированном буфере, а текст SFML меняется (и заново
+// раскладывает глифы) только когда меняется выводимое значение.
+class HudWidget {
+private:
+    sf::Text text;
+    const char* label;
+    const char* suffix;
+    char buffer[48] = {};
+    int value = 0;
+    bool visible = false;
+    bool formatted = false;
+
+public:
+    HudWidget(const sf::Font& font, const char* labelText, const char* suffixText, unsigned size, sf::Color color)
+        : text(font, "", size), label(labelText), suffix(suffixText) {
+        text.setFillColor(color);
+    }
+    
+    // Возвращает true, если изменился вид виджета
+    bool set(bool show, int newValue) {
+        if (!show) {
+            bool changed = visible;
+            visible = false;
+            return changed;
+        }
+        if (visible && formatted && newValue == value) {
+            return false;
+        }
+        
+        visible = true;
+        if (!formatted || newValue != value) {
+            value = newValue;
+            std::size_t labelLength = std::strlen(label);
+            std::size_t suffixLength = std::strlen(suffix);
+            std::memcpy(buffer, label, labelLength);
+            char* end = std::to_chars(buffer + labelLength, buffer + sizeof(buffer) - suffixLength - 1, value).ptr;
+            std::memcpy(end, suffix, suffixLength);
+            end[suffixLength] = '\0';
+            text.setString(buffer);
+            formatted = true;
+        }
+        return true;
+    }
+    
+    bool isVisible() const { return visible; }
+    
+    void setPosition(sf::Vector2f position) {
+        text.setPosition(position);
+    }
+    
+    // Позиция сразу за последним символом (с учетом пробелов в конце)
+    float endX() const {
+        return text.findCharacterPos(std::strlen(buffer)).x;
+    }
+    
+    void draw(sf::RenderTarget& target) const {
+        if (visible) {
+            target.draw(text);
+        }
+    }
+};
+
+// Счет и индикаторы бустов во время забега
+class Hud {
+private:
+    enum { ENERGY_WIDGET, SEEDS_WIDGET, MACASIN_WIDGET, MOPED_WIDGET, MOPED_STOCK_WIDGET, WIDGET_COUNT };
+    
+    HudWidget score;
+    HudWidget boosts[WIDGET_COUNT];
+    sf::Vector2f boostsPosition{10.0f, 50.0f};
+    bool layoutDirty = true;
+    
+    // Индикаторы идут в строку друг за другом, как раньше в одной строке
+    void layout() {
+        float x = boostsPosition.x;
+        for (auto& widget : boosts) {
+            if (widget.isVisible()) {
+                widget.setPosition({x, boostsPosition.y});
+                x = widget.endX();
+            }
+        }
+        layoutDirty = false;
+    }
+
+public:
+    explicit Hud(const sf::Font& font)
+        : score(font, "Score: ", "", 30, sf::Color::White),
+          boosts{{font, "ENERGY: ", "s ", 25, sf::Color::Yellow},
+                 {font, "SEEDS: ", "s ", 25, sf::Color::Yellow},
+                 {font, "MACASIN: ", "s ", 25, sf::Color::Yellow},
+                 {font, "MOPED: ", "s ", 25, sf::Color::Yellow},
+                 {font, "MOPEDx", " [Q] ", 25, sf::Color::Yellow}} {
+        score.setPosition({10.0f, 10.0f});
+    }
+    
+    void update(const RenderSnapshot& snapshot) {
+        score.set(true, snapshot.score);
+        
+        bool changed = false;
+        changed |= boosts[ENERGY_WIDGET].set(snapshot.energyActive, static_cast<int>(snapshot.energyLeft) + 1);
+        changed |= boosts[SEEDS_WIDGET].set(snapshot.seedsActive, static_cast<int>(snapshot.seedsLeft) + 1);
+        changed |= boosts[MACASIN_WIDGET].set(snapshot.macasinActive, static_cast<int>(snapshot.macasinLeft) + 1);
+        changed |= boosts[MOPED_WIDGET].set(snapshot.mopedActive, static_cast<int>(snapshot.mopedLeft) + 1);
+        changed |= boosts[MOPED_STOCK_WIDGET].set(snapshot.mopedCount > 0, snapshot.mopedCount);
+        if (changed) {
+            layoutDirty = true;
+        }
+    }
+    
+    void draw(sf::RenderTarget& target) {
+        if (layoutDirty) {
+            layout();
+        }
+        score.draw(target);
+        for (const auto& widget : boosts) {
+            widget.draw(target);
+        }
+    }
+};
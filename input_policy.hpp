@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cfloat>
+#include <string>
+#include "game_world.hpp"
+#include "autopilot.hpp"
+
+// Стратегия ввода для забегов без игрока: вызывается перед каждым тиком и
+// подает команды через world.applyCommand. У каждого забега свой Rng,
+// засеянный от seed забега, так что прогон повторяется один в один.
+using InputPolicy = void (*)(GameWorld& world, Rng& rng);
+
+// Ближайшее опасное препятствие на полосе: расстояние от игрока до его нижнего
+// края (0 - уже касается), FLT_MAX - в пределах lookahead пикселей ничего нет
+inline float laneThreat(const GameWorld& world, int lane, float lookahead, bool garagesOnly) {
+    float left = world.runnerX(Lane{lane});
+    float right = left + world.playerWidth;
+    float top = world.player<Runner>().baseY;
+    float bottom = top + world.playerHeight;
+    float nearest = FLT_MAX;
+    world.entities.each<Position, Extent, Obstacle>(
+        [&](const Position& position, const Extent& extent, const Obstacle& obstacle) {
+            if (garagesOnly && obstacle.type != 1) {
+                return;
+            }
+            if (position.x >= right || position.x + extent.w <= left || position.y >= bottom) {
+                return;
+            }
+            float distance = std::max(top - (position.y + extent.h), 0.0f);
+            if (distance < lookahead) {
+                nearest = std::min(nearest, distance);
+            }
+        });
+    return nearest;
+}
+
+// Ничего не нажимает: нижняя граница для сравнения
+inline void idlePolicy(GameWorld&, Rng&) {}
+
+// Случайные нажатия в среднем раз в четверть секунды
+inline void randomPolicy(GameWorld& world, Rng& rng) {
+    if (rng.nextInt(TICK_RATE / 4) != 0) {
+        return;
+    }
+    const Command commands[] = {Command::LANE_LEFT, Command::LANE_RIGHT, Command::JUMP, Command::JUMP, Command::MOPED};
+    world.applyCommand(commands[rng.nextInt(5)]);
+}
+
+// Простой реактивный игрок: гараж впереди - уйти на свободную полосу,
+// лавка - перепрыгнуть, деться некуда - сесть на мопед
+inline void dodgePolicy(GameWorld& world, Rng& rng) {
+    if (world.isMopedActive) {
+        return;
+    }
+    const float lookahead = world.obstacleSpeed * 0.4f;
+    const Jump& jump = world.player<Jump>();
+    bool airborne = jump.rising || jump.falling;
+    int lane = world.player<Lane>().lane;
+    
+    float garage = laneThreat(world, lane, lookahead, true);
+    float any = airborne ? garage : laneThreat(world, lane, lookahead, false);
+    if (any == FLT_MAX) {
+        return;
+    }
+    
+    // Перед гаражом (или лавкой, если прыжок уже идет) - смена полосы
+    if (garage != FLT_MAX || airborne) {
+        int first = rng.nextInt(2) == 0 ? -1 : 1;
+        for (int side : {first, -first}) {
+            int target = lane + side;
+            if (target >= 0 && target <= 2 && laneThreat(world, target, lookahead, false) == FLT_MAX) {
+                world.applyCommand(side < 0 ? Command::LANE_LEFT : Command::LANE_RIGHT);
+                return;
+            }
+        }
+        if (any < lookahead * 0.25f) {
+            world.applyCommand(Command::MOPED);
+        }
+        return;
+    }
+    
+    // Лавка: прыжок, когда до нее осталась четверть обзора
+    if (any < lookahead * 0.25f) {
+        world.applyCommand(Command::JUMP);
+    }
+}
+
+// Поиск на копиях мира (см. Autopilot); у каждого потока пакета свой автопилот
+inline void lookaheadPolicy(GameWorld& world, Rng&) {
+    thread_local Autopilot autopilot;
+    Command command;
+    if (autopilot.choose(world, command)) {
+        world.applyCommand(command);
+    }
+}
+
+struct NamedInputPolicy {
+    const char* name;
+    InputPolicy policy;
+};
+
+const NamedInputPolicy INPUT_POLICIES[] = {
+    {"idle", idlePolicy},
+    {"random", randomPolicy},
+    {"dodge", dodgePolicy},
+    {"lookahead", lookaheadPolicy},
+};
+
+// nullptr, если стратегии с таким именем нет
+inline InputPolicy findInputPolicy(const std::string& name) {
+    for (const auto& entry : INPUT_POLICIES) {
+        if (name == entry.name) {
+            return entry.policy;
+        }
+    }
+    return nullptr;
+}
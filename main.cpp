@@ -2,1137 +2,1466 @@
 #include <iostream>
 #include <vector>
 #include <cstdlib>
-#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <algorithm>
+#include <chrono>
+#include <string>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <cmath>
+#include "game_world.hpp"
+#include "render_snapshot.hpp"
+#include "triple_buffer.hpp"
+#include "spsc_queue.hpp"
+#include "replay.hpp"
+#include "texture_atlas.hpp"
+#include "road_renderer.hpp"
+#include "sprite_batch.hpp"
+#include "hud.hpp"
+#include "static_screen.hpp"
+#include "playfield_view.hpp"
+#include "frame_pacer.hpp"
+#include "profiler_overlay.hpp"
+#include "asset_loader.hpp"
+#include "asset_pack.hpp"
+#include "batch_runner.hpp"
+#include "autopilot.hpp"
+#include "rewind_buffer.hpp"
 
 using namespace sf;
 
+// Параметры запуска из командной строки
+// Диапазон перебора from..to с шагом step (--obstacle-ticks 40:120:8)
+struct SweepRange {
+    int from = 0;
+    int to = 0;
+    int step = 1;
+};
+
+struct Options {
+    bool headless = false;
+    long long ticks = 1000000;
+    bool hasSeed = false;
+    std::uint64_t seed = 0;
+    std::string replayPath;
+    float replaySpeed = 1.0f;
+    bool vsync = false;
+    int fpsLimit = 120;
+    bool fullscreen = false;
+    int renderScale = 100; // Внутренний масштаб игрового поля, % (F7 меняет на ходу)
+    int stressLevel = 0;
+    bool hasFollowers = false;
+    int followers = 1;
+    bool autopilot = false;
+    std::string recordPath; // Папка для повторов забегов без окна
+    bool hasRewind = false;
+    int rewindSeconds = 10; // Насколько далеко можно отмотать (Backspace)
+    bool packAssets = false;
+    
+    // Пакетный прогон: --batch N забегов на каждую конфигурацию баланса
+    int batchGames = 0;
+    std::string policy = "dodge";
+    SweepRange obstacleTicks{GameWorld::OBSTACLE_SPAWN_TICKS, GameWorld::OBSTACLE_SPAWN_TICKS, 1};
+    SweepRange boostTicks{GameWorld::BOOST_SPAWN_TICKS, GameWorld::BOOST_SPAWN_TICKS, 1};
+    std::vector<std::vector<int>> boostWeights; // Каждый --boost-weights - еще один вариант весов
+    long long maxGameTicks = TICK_RATE * 600;
+    unsigned threads = 0; // 0 - по числу ядер
+    std::string reportPath = "batch.csv";
+};
+
+// Пакет с заранее декодированными картинками (создается через --pack)
+const char* const ASSET_PACK_PATH = "assets.pack";
+const char* const ASSET_DIRECTORY = "spryte";
+
+// Множитель спавна нагрузочного режима по F2, если не задан --stress
+const int DEFAULT_STRESS_LEVEL = 1000;
+
+// Логическое поле: мир, экраны и HUD задаются в этих координатах,
+// окно любого размера показывает его целиком (см. letterboxView)
+const Vector2f FIELD_SIZE{GameWorld::FIELD_WIDTH, GameWorld::FIELD_HEIGHT};
+
+// Внутренние масштабы поля по F7, %
+const int RENDER_SCALES[] = {50, 75, 100, 150, 200};
+
+// Перемотка: потолок памяти под кадры и скорость (тиков назад за тик)
+const std::size_t REWIND_BUDGET_BYTES = 4 << 20;
+const int REWIND_STEP_TICKS = 2;
+
+// Случайный seed для нового забега
+std::uint64_t makeSeed() {
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+// Число спутников: --followers N, иначе один, а под нагрузкой - полная колонна
+int followerCount(const Options& options, int stressLevel) {
+    if (options.hasFollowers) {
+        return options.followers;
+    }
+    return stressLevel > 0 ? static_cast<int>(GameWorld::MAX_FOLLOWERS) : 1;
+}
+
 class RussiaRunner {
 private:
     RenderWindow window;
+    bool fullscreen = false;
+    
+    // Вид окна на логическое поле и холст, в который поле рисуется с масштабом renderScale
+    View fieldView;
+    ScaledCanvas playfield;
+    int renderScale = 100;
     
-    // Текстуры
-    Texture playerTexture;
-    Texture benchTexture;
-    Texture garageTexture;
-    Texture roadTexture;
-    Texture beerTexture;
-    Texture rubleTexture;
-    Texture energyTexture;
-    Texture seedsTexture;
-    Texture macasinTexture;
-    Texture mopedItemTexture;
-    std::vector<Texture> mopedRideTextures;
-    Sprite* playerSprite = nullptr;
+    // Текстуры: все картинки лежат в одном атласе, здесь только их прямоугольники
+    TextureAtlas atlas;
+    IntRect playerRect;
+    IntRect obstacleRects[2];
+    IntRect boostRects[6];
+    std::vector<IntRect> mopedRideFrames;
+    
+    // Цвета прямоугольников, если картинки нет
+    const Color obstacleColors[2] = {Color::Green, Color::Red};
+    const Color boostColors[6] = {Color(255, 200, 0), Color::Green, Color::Red, Color::Cyan, Color::Magenta, Color(150, 150, 150)};
+    
+    // Все спрайты мира рисуются одним пакетом из атласа
+    SpriteBatch batch;
+    
+    // Дорога отдельно от атласа: ей нужна повторяющаяся текстура
+    RoadRenderer roadRenderer;
     
     // Спутник с задержкой
-    std::vector<Texture> followerRunTextures;
-    Sprite* followerSprite = nullptr;
-    int followerCurrentFrame = 0;
-    float followerAnimationTimer = 0.0f;
-    float followerFrameTime = 0.1f;
-    int followerLane = 1;
-    bool followerIsJumping = false;
-    bool followerIsFalling = false;
-    float followerJumpHeight = 0.0f;
-    
-    // Задержка действий спутника
-    float followerActionDelay = 0.15f; // Задержка 0.15 секунды
-    float followerActionTimer = 0.0f;
-    bool followerNeedsToJump = false;
-    int followerTargetLane = 1;
+    std::vector<IntRect> followerRunFrames;
     
     // Анимация бега
-    std::vector<Texture> runTextures;
-    int currentFrame = 0;
-    float animationTimer = 0.0f;
-    float frameTime = 0.1f;
-    
-    // Анимация мопеда
-    int mopedRideFrame = 0;
-    float mopedRideAnimationTimer = 0.0f;
-    float mopedRideFrameTime = 0.1f;
-    
-    // Дорога
-    float roadOffset = 0.0f;
-    float roadSpeed = 300.0f;
-    float baseRoadSpeed = 300.0f;
-    
-    // Игрок
-    int currentLane = 1;
-    bool isJumping = false;
-    bool isFalling = false;
-    float jumpHeight = 0.0f;
-    float jumpSpeed = 400.0f;
-    float maxJumpHeight = 150.0f;
-    
-    // Дорожные полосы
-    float laneWidth;
-    std::vector<float> lanePositions;
-    
-    // Препятствия
-    struct Obstacle {
-        int type; // 0 - лавка, 1 - гараж
-        Vector2f position;
-        Vector2f size;
-    };
-    std::vector<Obstacle> obstacles;
-    float obstacleSpeed = 300.0f;
-    Clock spawnClock;
-    bool firstFrame = true;
-    
-    // Бусты
-    enum BoostType { BEER, RUBLE, ENERGY, SEEDS, MACASIN, MOPED };
-    struct Boost {
-        int type;
-        Vector2f position;
-        Vector2f size;
-        bool active;
-    };
-    std::vector<Boost> boosts;
-    Clock boostSpawnClock;
-    
-    // Активные бусты
-    bool hasEnergyBoost = false;
-    float energyTimer = 0.0f;
-    const float ENERGY_DURATION = 15.0f;
-    
-    bool hasSeedsBoost = false;
-    float seedsTimer = 0.0f;
-    const float SEEDS_DURATION = 15.0f;
-    
-    bool hasMacasinBoost = false;
-    float macasinTimer = 0.0f;
-    const float MACASIN_DURATION = 15.0f;
-    
-    // Мопед
-    int mopedCount = 1;
-    bool isMopedActive = false;
-    float mopedTimer = 0.0f;
-    const float MOPED_DURATION = 20.0f;
-    const int MAX_MOPEDS = 3;
-    float mopedCooldown = 0.0f;
-    
-    // Счет
-    int score = 0;
-    int scoreMultiplier = 1;
-    Clock scoreClock;
-    Text* scoreText = nullptr;
-    Text* boostTimerText = nullptr;
+    std::vector<IntRect> runFrames;
+    
+    // Симуляция забега идет в своем потоке: команды игрока приходят туда
+    // через очередь, а окно рисует последний снимок из тройного буфера.
+    // Пока поток запущен, world, recorder и replayReader трогает только он.
+    Options options;
+    FramePacer pacer;
+    TrackFeed trackFeed; // Куски трассы строятся в своем фоновом потоке
+    GameWorld world;
+    std::thread simulationThread;
+    std::atomic<bool> simulationStop{false};
+    SpscQueue<Command, 256> commands;
+    TripleBuffer<RenderSnapshot> snapshots;
+    double stepSeconds = 0.0; // Суммарное время тиков, пишет поток симуляции
+    
+    // Автопилот (F6) играет вместо игрока в потоке симуляции; его ходы пишутся
+    // в повтор как обычные команды
+    std::atomic<bool> autopilotEnabled{false};
+    Autopilot autopilot;
+    
+    // Перемотка (пока зажат Backspace): состояния последних секунд пишет поток симуляции
+    RewindBuffer rewind;
+    std::atomic<bool> rewinding{false};
+    
+    // Запись и просмотр повторов
+    ReplayRecorder recorder;
+    MappedFile replayFile;
+    ReplayReader replayReader;
+    bool watchingReplay = false;
+    
+    // Счет и индикаторы бустов
+    Hud* hud = nullptr;
+    
+    // Нагрузочный режим (F2 или --stress): счетчики и время за кадр и за тик
+    int stressLevel = 0;
+    Text* stressText = nullptr;
+    Clock stressClock;
+    int stressFrames = 0;
+    double stressRenderSeconds = 0.0;
+    long long stressTick = 0;
+    double stressStepSeconds = 0.0;
+    double stressCollisionSeconds = 0.0;
+    
+#ifdef RR_PROFILE
+    // Профилировщик: F3 - оверлей, F4 - трасса последних секунд в traces/
+    ProfilerOverlay* profilerOverlay = nullptr;
+#endif
     
     // Меню
     enum GameState { MENU, PLAYING, CONTROLS, GAME_OVER };
     GameState currentState = MENU;
     Font font;
-    Text* titleText = nullptr;
-    Text* playText = nullptr;
-    Text* controlsText = nullptr;
-    Text* exitText = nullptr;
-    Text* backText = nullptr;
+    
+    // Статичные экраны рисуются заново только после изменений
+    StaticScreen menuScreen;
+    StaticScreen controlsScreen;
+    StaticScreen gameOverScreen;
+    std::size_t playItem = 0;
+    std::size_t controlsItem = 0;
+    std::size_t exitItem = 0;
+    std::size_t backItem = 0;
+    std::size_t finalScoreItem = 0;
+    bool screenChanged = true;
     
 public:
-    RussiaRunner() : window(VideoMode({600, 600}), "Russia runner") {
-        std::srand(std::time(nullptr));
+    explicit RussiaRunner(const Options& launchOptions)
+        : renderScale(launchOptions.renderScale), options(launchOptions), autopilotEnabled(launchOptions.autopilot),
+          stressLevel(launchOptions.stressLevel) {
+        // Вертикальная синхронизация и ограничение FPS задаются при запуске
+        createWindow(options.fullscreen);
+        pacer.setTargetFps(options.fpsLimit);
+        rewind.configure(static_cast<std::size_t>(options.rewindSeconds) * TICK_RATE + 1, REWIND_BUDGET_BYTES);
+        world.trackFeed = &trackFeed;
+#ifdef RR_PROFILE
+        world.profiled.enabled = true;
+#endif
+        
         setup();
+        updateLayout();
+        
+        // Просмотр повтора сразу запускает забег
+        if (!options.replayPath.empty()) {
+            if (replayFile.open(options.replayPath) && replayReader.open(replayFile.data(), replayFile.size())) {
+                watchingReplay = true;
+                currentState = PLAYING;
+                resetGame();
+            } else {
+                std::cout << "Could not load replay: " << options.replayPath << std::endl;
+            }
+        }
     }
     
     ~RussiaRunner() {
-        if (playerSprite) delete playerSprite;
-        if (followerSprite) delete followerSprite;
-        if (titleText) delete titleText;
-        if (playText) delete playText;
-        if (controlsText) delete controlsText;
-        if (exitText) delete exitText;
-        if (backText) delete backText;
-        if (scoreText) delete scoreText;
-        if (boostTimerText) delete boostTimerText;
+        stopSimulation();
+        if (hud) delete hud;
+        if (stressText) delete stressText;
+#ifdef RR_PROFILE
+        if (profilerOverlay) delete profilerOverlay;
+#endif
+    }
+    
+    // Окно или весь экран; на игру размер окна не влияет - поле всегда логическое
+    void createWindow(bool fullscreenMode) {
+        fullscreen = fullscreenMode;
+        if (fullscreen) {
+            window.create(VideoMode::getDesktopMode(), "Russia runner", State::Fullscreen);
+        } else {
+            window.create(VideoMode(Vector2u(FIELD_SIZE)), "Russia runner");
+        }
+        window.setVerticalSyncEnabled(options.vsync);
+        fieldView = letterboxView(FIELD_SIZE, window.getSize());
+        window.setView(fieldView);
+    }
+    
+    // Вид и холсты под текущий размер окна и масштаб поля
+    void updateLayout() {
+        fieldView = letterboxView(FIELD_SIZE, window.getSize());
+        window.setView(fieldView);
+        Vector2u pixels(window.getViewport(fieldView).size);
+        playfield.resize(FIELD_SIZE, pixels, renderScale / 100.0f);
+        menuScreen.resize(pixels);
+        controlsScreen.resize(pixels);
+        gameOverScreen.resize(pixels);
+        screenChanged = true;
+    }
+    
+    // События окна в любом состоянии: изменение размера, F11 - весь экран,
+    // F7 - следующий внутренний масштаб поля
+    void handleWindowEvent(const Event& event) {
+        if (event.is<Event::Resized>()) {
+            updateLayout();
+        }
+        if (auto keyPressed = event.getIf<Event::KeyPressed>()) {
+            if (keyPressed->scancode == Keyboard::Scan::F11) {
+                createWindow(!fullscreen);
+                updateLayout();
+            }
+            else if (keyPressed->scancode == Keyboard::Scan::F7) {
+                int next = RENDER_SCALES[0];
+                for (int scale : RENDER_SCALES) {
+                    if (scale > renderScale) {
+                        next = scale;
+                        break;
+                    }
+                }
+                renderScale = next;
+                updateLayout();
+            }
+        }
     }
     
     void setup() {
+        // Картинки берутся из assets.pack без декодирования; недостающие
+        // (или все, если пакета нет) декодируются из PNG в фоне, пока создаются тексты
+        AssetPack pack;
+        if (!pack.open(ASSET_PACK_PATH)) {}
+        std::vector<std::pair<std::string, const AssetPackEntry*>> packedAssets;
+        AssetLoader loader;
+        for (const auto& asset : assetFiles()) {
+            const AssetPackEntry* entry = pack.isOpen() ? pack.find(asset.second) : nullptr;
+            if (entry) {
+                packedAssets.push_back({asset.first, entry});
+            } else {
+                loader.add(asset.first, std::string(ASSET_DIRECTORY) + "/" + asset.second + ".png");
+            }
+        }
+        loader.start();
+        
         if (!font.openFromFile("C:/Windows/Fonts/arial.ttf")) {
             return;
         }
         
+        
         // Тексты меню
-        titleText = new Text(font, "RUSSIA RUNNER", 50);
-        titleText->setFillColor(Color::Red);
-        titleText->setPosition({150.0f, 150.0f});
+        menuScreen.create(FIELD_SIZE, Color(30, 30, 30));
+        menuScreen.addText(font, "RUSSIA RUNNER", 50, Color::Red, {150.0f, 150.0f});
+        playItem = menuScreen.addText(font, "GAME", 40, Color::White, {250.0f, 300.0f}, true);
+        controlsItem = menuScreen.addText(font, "CONTROLS", 40, Color::White, {230.0f, 370.0f}, true);
+        exitItem = menuScreen.addText(font, "EXIT", 40, Color::White, {250.0f, 440.0f}, true);
+        
+        // Тексты экрана управления
+        controlsScreen.create(FIELD_SIZE, Color(30, 30, 50));
+        controlsScreen.addText(font, "BOOSTS", 50, Color::Yellow, {220.0f, 60.0f});
+        controlsScreen.addText(font, "BEER +100 points", 25, Color(255, 200, 0), {150.0f, 140.0f});
+        controlsScreen.addText(font, "RUBLE +50 points", 25, Color::Green, {150.0f, 180.0f});
+        controlsScreen.addText(font, "ENERGY +20% speed (15s)", 25, Color::Red, {150.0f, 220.0f});
+        controlsScreen.addText(font, "SEEDS 2x points (15s)", 25, Color::Cyan, {150.0f, 260.0f});
+        controlsScreen.addText(font, "MACASIN jump over GARAGES (15s)", 25, Color::Magenta, {150.0f, 300.0f});
+        controlsScreen.addText(font, "MOPED [Q] - invincibility (20s or 1 hit)", 25, Color(150, 150, 150), {150.0f, 340.0f});
+        controlsScreen.addText(font, "Can stack up to 3 mopeds", 20, Color(150, 150, 150), {150.0f, 370.0f});
+        controlsScreen.addText(font, "ESC - Back to Menu", 30, Color::White, {150.0f, 410.0f});
+        controlsScreen.addText(font, "R - Restart (in game)", 30, Color::White, {150.0f, 460.0f});
+        backItem = controlsScreen.addText(font, "BACK (ESC)", 35, Color::Green, {220.0f, 520.0f}, true);
+        
+        // Тексты Game Over
+        gameOverScreen.create(FIELD_SIZE, Color(30, 0, 0));
+        gameOverScreen.addText(font, "GAME OVER!", 40, Color::Red, {180.0f, 150.0f});
+        finalScoreItem = gameOverScreen.addText(font, "Final Score: 0", 35, Color::Yellow, {170.0f, 220.0f});
+        gameOverScreen.addText(font, "Press R for restart", 30, Color::White, {190.0f, 300.0f});
+        gameOverScreen.addText(font, "ESC for escape to menu", 30, Color::White, {170.0f, 350.0f});
         
-        playText = new Text(font, "GAME", 40);
-        playText->setFillColor(Color::White);
-        playText->setPosition({250.0f, 300.0f});
+        // Тексты игры
+        hud = new Hud(font);
         
-        controlsText = new Text(font, "CONTROLS", 40);
-        controlsText->setFillColor(Color::White);
-        controlsText->setPosition({230.0f, 370.0f});
+        stressText = new Text(font, "", 16);
+        stressText->setFillColor(Color::Cyan);
+        stressText->setPosition({10.0f, 555.0f});
         
-        exitText = new Text(font, "EXIT", 40);
-        exitText->setFillColor(Color::White);
-        exitText->setPosition({250.0f, 440.0f});
+#ifdef RR_PROFILE
+        profilerOverlay = new ProfilerOverlay(font);
+#endif
         
-        // Тексты игры
-        scoreText = new Text(font, "Score: 0", 30);
-        scoreText->setFillColor(Color::White);
-        scoreText->setPosition({10.0f, 10.0f});
+        // Ожидание декодирования с экраном загрузки
+        showLoadingScreen(loader);
+        loader.wait();
         
-        boostTimerText = new Text(font, "", 25);
-        boostTimerText->setFillColor(Color::Yellow);
-        boostTimerText->setPosition({10.0f, 50.0f});
+        // В видеопамять: картинки перемещаются в атлас, дорога - в свою текстуру
+        for (const auto& asset : packedAssets) {
+            const AssetPackEntry& entry = *asset.second;
+            Image image({entry.width, entry.height}, pack.pixels(entry));
+            useImage(asset.first, image);
+        }
+        loader.forEachLoaded([this](const std::string& name, Image& image) {
+            useImage(name, image);
+        });
+        atlas.add("white", Image({4, 4}, Color::White));
         
-        // Загрузка текстур анимации бега
-        for (int i = 1; i <= 4; ++i) {
-            Texture texture;
-            std::string filename = "spryte/run" + std::to_string(i) + ".png";
-            if (!texture.loadFromFile(filename)) {
-            } else {
-                runTextures.push_back(texture);
-            }
+        if (!atlas.build()) {
+            std::cout << "Could not build texture atlas" << std::endl;
         }
         
-        // Загрузка текстур анимации бега спутника
+        // Кадры анимаций и прямоугольники объектов
+        for (int i = 1; i <= 4; ++i) {
+            if (atlas.has("run" + std::to_string(i))) runFrames.push_back(atlas.get("run" + std::to_string(i)));
+            if (atlas.has("moped_ride" + std::to_string(i))) mopedRideFrames.push_back(atlas.get("moped_ride" + std::to_string(i)));
+        }
         for (int i = 1; i <= 3; ++i) {
-            Texture texture;
-            std::string filename = "spryte/follower_run" + std::to_string(i) + ".png";
-            if (!texture.loadFromFile(filename)) {
-                std::cout << "Could not load follower texture: " << filename << std::endl;
+            std::string name = "follower_run" + std::to_string(i);
+            if (atlas.has(name)) {
+                followerRunFrames.push_back(atlas.get(name));
             } else {
-                followerRunTextures.push_back(texture);
+                std::cout << "Could not load follower texture: spryte/" << name << ".png" << std::endl;
             }
         }
         
-        // Загрузка текстур объектов
-        if (!roadTexture.loadFromFile("spryte/road.png")) {}
-        if (!benchTexture.loadFromFile("spryte/beanch.png")) {}
-        if (!garageTexture.loadFromFile("spryte/garage.png")) {}
-        if (!beerTexture.loadFromFile("spryte/beer.png")) {}
-        if (!rubleTexture.loadFromFile("spryte/ruble.png")) {}
-        if (!energyTexture.loadFromFile("spryte/energy.png")) {}
-        if (!seedsTexture.loadFromFile("spryte/seeds.png")) {}
-        if (!macasinTexture.loadFromFile("spryte/macasin.png")) {}
+        playerRect = atlas.get("player");
+        obstacleRects[0] = atlas.get("bench");
+        obstacleRects[1] = atlas.get("garage");
+        boostRects[BEER] = atlas.get("beer");
+        boostRects[RUBLE] = atlas.get("ruble");
+        boostRects[ENERGY] = atlas.get("energy");
+        boostRects[SEEDS] = atlas.get("seeds");
+        boostRects[MACASIN] = atlas.get("macasin");
+        boostRects[MOPED] = atlas.get("moped_item");
         
-        // Загрузка текстур мопеда
-        if (!mopedItemTexture.loadFromFile("spryte/moped_item.png")) {}
+        // Инициализация дорожных полос
+        world.setFieldWidth(GameWorld::FIELD_WIDTH);
+        roadRenderer.build(world.lanePositions, 3, world.laneWidth, GameWorld::FIELD_HEIGHT);
+        
+        // Пакет рисует атлас; белый участок берется с отступом от края
+        if (atlas.has("white")) {
+            batch.setTexture(0, &atlas.getTexture());
+            IntRect white = atlas.get("white");
+            batch.setSolidRect(IntRect({white.position.x + 1, white.position.y + 1}, {2, 2}));
+        }
         
-        for (int i = 1; i <= 4; ++i) {
-            Texture texture;
-            std::string filename = "spryte/moped_ride" + std::to_string(i) + ".png";
-            if (!texture.loadFromFile(filename)) {
+        // Хитбокс игрока по размеру первого кадра (спрайты в масштабе 0.8)
+        if (!runFrames.empty()) {
+            playerRect = runFrames[0];
+        }
+        if (playerRect.size.x > 0) {
+            world.playerWidth = playerRect.size.x * 0.8f;
+            world.playerHeight = playerRect.size.y * 0.8f;
+            
+            if (!mopedRideFrames.empty()) {
+                world.mopedWidth = mopedRideFrames[0].size.x * 0.8f;
+                world.mopedHeight = mopedRideFrames[0].size.y * 0.8f;
             } else {
-                mopedRideTextures.push_back(texture);
+                world.mopedWidth = world.playerWidth;
+                world.mopedHeight = world.playerHeight;
             }
         }
         
-        // Инициализация дорожных полос
-        float totalWidth = window.getSize().x;
-        laneWidth = totalWidth / 4.0f;
-        float offset = (totalWidth - (laneWidth * 3)) / 2.0f;
-        lanePositions = {offset, offset + laneWidth, offset + laneWidth * 2};
-        
-        // Создание спрайта игрока
-        if (!runTextures.empty()) {
-            playerSprite = new Sprite(runTextures[0]);
-        } else if (playerTexture.loadFromFile("spryte/player.png")) {
-            playerSprite = new Sprite(playerTexture);
-        } else {
-            playerSprite = nullptr;
+        // Параметры анимаций и дороги для симуляции
+        world.runFrameCount = static_cast<int>(runFrames.size());
+        world.followerFrameCount = static_cast<int>(followerRunFrames.size());
+        world.mopedRideFrameCount = static_cast<int>(mopedRideFrames.size());
+        world.roadTileHeight = roadRenderer.getTileHeight();
+    }
+    
+    // Картинки игры: имя в атласе и имя файла в spryte/ без .png
+    static std::vector<std::pair<std::string, std::string>> assetFiles() {
+        std::vector<std::pair<std::string, std::string>> files;
+        for (int i = 1; i <= 4; ++i) {
+            files.push_back({"run" + std::to_string(i), "run" + std::to_string(i)});
         }
-        
-        if (playerSprite) {
-            playerSprite->setScale({0.8f, 0.8f});
+        for (int i = 1; i <= 3; ++i) {
+            files.push_back({"follower_run" + std::to_string(i), "follower_run" + std::to_string(i)});
         }
-        
-        // Создание спрайта спутника
-        if (!followerRunTextures.empty()) {
-            followerSprite = new Sprite(followerRunTextures[0]);
-            followerSprite->setScale({0.8f, 0.8f});
-        } else {
-            followerSprite = nullptr;
+        for (int i = 1; i <= 4; ++i) {
+            files.push_back({"moped_ride" + std::to_string(i), "moped_ride" + std::to_string(i)});
         }
-        
-        updatePlayerPosition();
-        updateFollowerPosition();
+        files.push_back({"player", "player"});
+        files.push_back({"bench", "beanch"});
+        files.push_back({"garage", "garage"});
+        files.push_back({"beer", "beer"});
+        files.push_back({"ruble", "ruble"});
+        files.push_back({"energy", "energy"});
+        files.push_back({"seeds", "seeds"});
+        files.push_back({"macasin", "macasin"});
+        files.push_back({"moped_item", "moped_item"});
+        files.push_back({"road", "road"});
+        return files;
     }
     
-    // Обновление позиции спутника
-    void updateFollowerPosition() {
-        float x = lanePositions[followerLane] + laneWidth/2 - 25;
-        float y = 560.0f - followerJumpHeight;
-        if (followerSprite) {
-            followerSprite->setPosition({x, y});
+    // Готовая картинка: дорога - в свою текстуру, остальное перемещается в атлас
+    void useImage(const std::string& name, Image& image) {
+        if (name == "road") {
+            if (!roadRenderer.loadFromImage(image)) {}
+        } else {
+            atlas.add(name, std::move(image));
         }
     }
     
-    // Обновление анимации спутника
-    void updateFollowerAnimation(float deltaTime) {
-        if (!followerRunTextures.empty() && followerSprite) {
-            followerAnimationTimer += deltaTime;
-            if (followerAnimationTimer >= followerFrameTime) {
-                followerCurrentFrame = (followerCurrentFrame + 1) % followerRunTextures.size();
-                followerSprite->setTexture(followerRunTextures[followerCurrentFrame]);
-                followerAnimationTimer = 0.0f;
+    // Экран загрузки: полоса прогресса, пока потоки декодируют картинки
+    void showLoadingScreen(AssetLoader& loader) {
+        RectangleShape frame({400.0f, 30.0f});
+        frame.setPosition({100.0f, 285.0f});
+        frame.setFillColor(Color::Transparent);
+        frame.setOutlineColor(Color::White);
+        frame.setOutlineThickness(2.0f);
+        
+        RectangleShape bar({0.0f, 30.0f});
+        bar.setPosition({100.0f, 285.0f});
+        bar.setFillColor(Color::Red);
+        
+        Text loadingText(font, "Loading...", 30);
+        loadingText.setFillColor(Color::White);
+        loadingText.setPosition({100.0f, 235.0f});
+        
+        while (!loader.finished()) {
+            // Окно закрыли: недекодированные файлы пропускаются
+            if (auto event = window.waitEvent(milliseconds(16))) {
+                if (event->is<Event::Closed>()) {
+                    loader.cancel();
+                    window.close();
+                } else {
+                    handleWindowEvent(*event);
+                }
             }
+            
+            float progress = loader.total() > 0 ? static_cast<float>(loader.done()) / loader.total() : 1.0f;
+            bar.setSize({400.0f * progress, 30.0f});
+            
+            window.clear(Color(30, 30, 30));
+            window.draw(loadingText);
+            window.draw(frame);
+            window.draw(bar);
+            window.display();
         }
     }
     
-    // Обновление логики спутника с задержкой
-    void updateFollower(float deltaTime) {
-        followerActionTimer += deltaTime;
-        
-        if (followerActionTimer >= followerActionDelay) {
-            // Обновляем действия спутника с задержкой
-            followerTargetLane = currentLane;
-            followerNeedsToJump = isJumping && !isFalling;
-            
-            followerActionTimer = 0.0f;
+    // Спрайт из атласа или цветной прямоугольник, если картинки нет
+    void batchEntity(const IntRect& rect, Color fallbackColor, const FloatRect& dest) {
+        if (rect.size.x > 0) {
+            batch.addSprite(0, rect, dest);
+        } else {
+            batch.addRect(0, dest, fallbackColor);
         }
-        
-        // Плавное перемещение между полосами
-        if (followerLane != followerTargetLane) {
-            if (followerLane < followerTargetLane) {
-                followerLane++;
-            } else if (followerLane > followerTargetLane) {
-                followerLane--;
-            }
-            updateFollowerPosition();
+    }
+    
+    // Текущий кадр игрока
+    IntRect playerFrame(const RenderSnapshot& snapshot) const {
+        if (snapshot.mopedActive && !mopedRideFrames.empty()) {
+            return mopedRideFrames[snapshot.mopedRideFrame];
         }
-        
-        // Прыжок с задержкой
-        if (followerNeedsToJump && !followerIsJumping && !followerIsFalling) {
-            followerIsJumping = true;
-            followerJumpHeight = 0.0f;
-            followerNeedsToJump = false;
+        if (!runFrames.empty()) {
+            return runFrames[snapshot.player.frame];
         }
-        
-        // Логика прыжка спутника
-        if (followerIsJumping) {
-            followerJumpHeight += jumpSpeed * deltaTime;
-            if (followerJumpHeight >= maxJumpHeight) {
-                followerIsJumping = false;
-                followerIsFalling = true;
+        return playerRect;
+    }
+    
+    // Цвет игрока с эффектами бустов
+    Color playerTint(const RenderSnapshot& snapshot) const {
+        if (snapshot.mopedActive) {
+            if (static_cast<int>(snapshot.mopedLeft * 10) % 2 == 0) {
+                return Color(100, 100, 255, 200);
             }
-            updateFollowerPosition();
+            return Color(200, 200, 255, 150);
         }
-        else if (followerIsFalling) {
-            followerJumpHeight -= jumpSpeed * deltaTime;
-            if (followerJumpHeight <= 0.0f) {
-                followerIsFalling = false;
-                followerJumpHeight = 0.0f;
-            }
-            updateFollowerPosition();
+        if (snapshot.energyActive && static_cast<int>(snapshot.energyLeft * 10) % 2 == 0) {
+            return Color(255, 100, 100);
         }
-        
-        updateFollowerAnimation(deltaTime);
+        if (snapshot.seedsActive && static_cast<int>(snapshot.seedsLeft * 10) % 2 == 0) {
+            return Color(100, 255, 255);
+        }
+        if (snapshot.macasinActive && static_cast<int>(snapshot.macasinLeft * 10) % 2 == 0) {
+            return Color(255, 100, 255);
+        }
+        return Color::White;
     }
     
-    // Обработка ввода в меню
-    void handleMenuInput() {
-        for (auto event = window.pollEvent(); event.has_value(); event = window.pollEvent()) {
-            if (event->is<Event::Closed>()) {
-                window.close();
-                return;
-            }
-            
-            if (auto mousePressed = event->getIf<Event::MouseButtonPressed>()) {
-                if (mousePressed->button == Mouse::Button::Left) {
-                    Vector2f mousePos = window.mapPixelToCoords({mousePressed->position.x, mousePressed->position.y});
-                    
-                    if (playText->getGlobalBounds().contains(mousePos)) {
-                        currentState = PLAYING;
-                        resetGame();
-                    }
-                    
-                    if (controlsText->getGlobalBounds().contains(mousePos)) {
-                        currentState = CONTROLS;
-                    }
-                    
-                    if (exitText->getGlobalBounds().contains(mousePos)) {
-                        window.close();
-                    }
-                }
-            }
-            
-            if (auto keyPressed = event->getIf<Event::KeyPressed>()) {
-                if (keyPressed->scancode == Keyboard::Scan::Enter) {
+    // Цвет игрока без спрайта
+    Color playerFallbackColor(const RenderSnapshot& snapshot) const {
+        if (snapshot.mopedActive) {
+            return Color::Blue;
+        } else if (snapshot.energyActive) {
+            return Color::Red;
+        } else if (snapshot.seedsActive) {
+            return Color::Cyan;
+        } else if (snapshot.macasinActive) {
+            return Color::Magenta;
+        }
+        return Color::Blue;
+    }
+    
+    // Обработка события в меню
+    void handleMenuEvent(const Event& event) {
+        if (event.is<Event::Closed>()) {
+            window.close();
+            return;
+        }
+        
+        if (auto mousePressed = event.getIf<Event::MouseButtonPressed>()) {
+            if (mousePressed->button == Mouse::Button::Left) {
+                Vector2f mousePos = window.mapPixelToCoords({mousePressed->position.x, mousePressed->position.y});
+                
+                if (menuScreen.contains(playItem, mousePos)) {
                     currentState = PLAYING;
                     resetGame();
                 }
-                else if (keyPressed->scancode == Keyboard::Scan::Escape) {
+                
+                if (menuScreen.contains(controlsItem, mousePos)) {
+                    currentState = CONTROLS;
+                }
+                
+                if (menuScreen.contains(exitItem, mousePos)) {
                     window.close();
                 }
             }
         }
-    }
-    
-    // Обработка ввода в управлении
-    void handleControlsInput() {
-        for (auto event = window.pollEvent(); event.has_value(); event = window.pollEvent()) {
-            if (event->is<Event::Closed>()) {
-                window.close();
-                return;
+        
+        if (auto mouseMoved = event.getIf<Event::MouseMoved>()) {
+            screenChanged |= menuScreen.updateHover(window.mapPixelToCoords({mouseMoved->position.x, mouseMoved->position.y}));
+        }
+        
+        if (auto keyPressed = event.getIf<Event::KeyPressed>()) {
+            if (keyPressed->scancode == Keyboard::Scan::Enter) {
+                currentState = PLAYING;
+                resetGame();
             }
-            
-            if (auto mousePressed = event->getIf<Event::MouseButtonPressed>()) {
-                if (mousePressed->button == Mouse::Button::Left) {
-                    Vector2f mousePos = window.mapPixelToCoords({mousePressed->position.x, mousePressed->position.y});
-                    if (backText && backText->getGlobalBounds().contains(mousePos)) {
-                        currentState = MENU;
-                    }
-                }
+            else if (keyPressed->scancode == Keyboard::Scan::Escape) {
+                window.close();
             }
-            
-            if (auto keyPressed = event->getIf<Event::KeyPressed>()) {
-                if (keyPressed->scancode == Keyboard::Scan::Escape) {
+        }
+    }
+    
+    // Обработка события в управлении
+    void handleControlsEvent(const Event& event) {
+        if (event.is<Event::Closed>()) {
+            window.close();
+            return;
+        }
+        
+        if (auto mousePressed = event.getIf<Event::MouseButtonPressed>()) {
+            if (mousePressed->button == Mouse::Button::Left) {
+                Vector2f mousePos = window.mapPixelToCoords({mousePressed->position.x, mousePressed->position.y});
+                if (controlsScreen.contains(backItem, mousePos)) {
                     currentState = MENU;
                 }
             }
         }
+        
+        if (auto mouseMoved = event.getIf<Event::MouseMoved>()) {
+            screenChanged |= controlsScreen.updateHover(window.mapPixelToCoords({mouseMoved->position.x, mouseMoved->position.y}));
+        }
+        
+        if (auto keyPressed = event.getIf<Event::KeyPressed>()) {
+            if (keyPressed->scancode == Keyboard::Scan::Escape) {
+                currentState = MENU;
+            }
+        }
     }
     
     // Отрисовка меню
     void renderMenu() {
-        window.clear(Color(30, 30, 30));
-        window.draw(*titleText);
-        window.draw(*playText);
-        window.draw(*controlsText);
-        window.draw(*exitText);
+        menuScreen.draw(window);
         window.display();
     }
     
     // Отрисовка управления
     void renderControls() {
-        window.clear(Color(30, 30, 50));
-        
-        Text controlsTitle(font, "BOOSTS", 50);
-        controlsTitle.setFillColor(Color::Yellow);
-        controlsTitle.setPosition({220.0f, 60.0f});
-        
-        Text beerText(font, "BEER +100 points", 25);
-        beerText.setFillColor(Color(255, 200, 0));
-        beerText.setPosition({150.0f, 140.0f});
-        
-        Text rubleText(font, "RUBLE +50 points", 25);
-        rubleText.setFillColor(Color::Green);
-        rubleText.setPosition({150.0f, 180.0f});
-        
-        Text energyText(font, "ENERGY +20% speed (15s)", 25);
-        energyText.setFillColor(Color::Red);
-        energyText.setPosition({150.0f, 220.0f});
-        
-        Text seedsText(font, "SEEDS 2x points (15s)", 25);
-        seedsText.setFillColor(Color::Cyan);
-        seedsText.setPosition({150.0f, 260.0f});
-        
-        Text macasinText(font, "MACASIN jump over GARAGES (15s)", 25);
-        macasinText.setFillColor(Color::Magenta);
-        macasinText.setPosition({150.0f, 300.0f});
-        
-        Text mopedText(font, "MOPED [Q] - invincibility (20s or 1 hit)", 25);
-        mopedText.setFillColor(Color(150, 150, 150));
-        mopedText.setPosition({150.0f, 340.0f});
-        
-        Text mopedStackText(font, "Can stack up to 3 mopeds", 20);
-        mopedStackText.setFillColor(Color(150, 150, 150));
-        mopedStackText.setPosition({150.0f, 370.0f});
-        
-        Text menuText(font, "ESC - Back to Menu", 30);
-        menuText.setFillColor(Color::White);
-        menuText.setPosition({150.0f, 410.0f});
-        
-        Text restartText(font, "R - Restart (in game)", 30);
-        restartText.setFillColor(Color::White);
-        restartText.setPosition({150.0f, 460.0f});
-        
-        backText = new Text(font, "BACK (ESC)", 35);
-        backText->setFillColor(Color::Green);
-        backText->setPosition({220.0f, 520.0f});
-        
-        window.draw(controlsTitle);
-        window.draw(beerText);
-        window.draw(rubleText);
-        window.draw(energyText);
-        window.draw(seedsText);
-        window.draw(macasinText);
-        window.draw(mopedText);
-        window.draw(mopedStackText);
-        window.draw(menuText);
-        window.draw(restartText);
-        window.draw(*backText);
-        
+        controlsScreen.draw(window);
         window.display();
     }
     
-    // Обновление позиции игрока
-    void updatePlayerPosition() {
-        float x = lanePositions[currentLane] + laneWidth/2 - 25;
-        float y = 500.0f - jumpHeight;
-        if (playerSprite) {
-            playerSprite->setPosition({x, y});
-        }
-    }
-    
-    // Создание препятствий
-    void spawnObstacle() {
-        if (spawnClock.getElapsedTime().asSeconds() > 0.8f) {
-            Obstacle obstacle;
-            obstacle.type = std::rand() % 2;
-            
-            if (obstacle.type == 0) {
-                obstacle.size = Vector2f{60.0f, 30.0f};
-            } else {
-                obstacle.size = Vector2f{80.0f, 80.0f};
-            }
-            
-            int lane = std::rand() % 3;
-            float x = lanePositions[lane] + laneWidth/2 - obstacle.size.x/2;
-            obstacle.position = {x, -obstacle.size.y};
-            
-            obstacles.push_back(obstacle);
-            spawnClock.restart();
-        }
-    }
-    
-    // Создание бустов
-    void spawnBoost() {
-        if (boostSpawnClock.getElapsedTime().asSeconds() > 5.0f && boosts.size() < 3) {
-            Boost boost;
-            boost.type = std::rand() % 6;
-            boost.size = Vector2f{40.0f, 40.0f};
-            boost.active = true;
-            
-            int lane = std::rand() % 3;
-            float x = lanePositions[lane] + laneWidth/2 - boost.size.x/2;
-            boost.position = {x, -boost.size.y};
-            
-            boosts.push_back(boost);
-            boostSpawnClock.restart();
+    // Обработка ввода в игре
+    void handleGameInput() {
+        RR_PROFILE_ZONE("handleGameInput");
+        for (auto event = window.pollEvent(); event.has_value() && currentState == PLAYING; event = window.pollEvent()) {
+            handleWindowEvent(*event);
+            handleGameEvent(*event);
         }
     }
     
-    // Обновление препятствий
-    void updateObstacles(float deltaTime) {
-        if (firstFrame) {
-            firstFrame = false;
+    // Обработка события в игре и на экране Game Over
+    void handleGameEvent(const Event& event) {
+        if (event.is<Event::Closed>()) {
+            finishRecording();
+            window.close();
             return;
         }
         
-        if (deltaTime > 0.1f) deltaTime = 0.1f;
-        
-        for (auto& obstacle : obstacles) {
-            obstacle.position.y += obstacleSpeed * deltaTime;
-        }
-        
-        obstacles.erase(std::remove_if(obstacles.begin(), obstacles.end(),
-            [](const Obstacle& o) { 
-                return o.position.y > 650.0f;
-            }),
-            obstacles.end());
-    }
-    
-    // Обновление бустов
-    void updateBoosts(float deltaTime) {
-        for (auto& boost : boosts) {
-            if (boost.active) {
-                boost.position.y += obstacleSpeed * deltaTime;
+        if (auto keyPressed = event.getIf<Event::KeyPressed>()) {
+            if (keyPressed->scancode == Keyboard::Scan::A || keyPressed->scancode == Keyboard::Scan::Left) {
+                issueCommand(Command::LANE_LEFT);
             }
-        }
-        
-        boosts.erase(std::remove_if(boosts.begin(), boosts.end(),
-            [](const Boost& b) { 
-                return b.position.y > 650.0f || !b.active;
-            }),
-            boosts.end());
-    }
-    
-    // Применение эффектов бустов
-    void applyBoostEffect(int boostType) {
-        switch (boostType) {
-            case BEER:
-                score += 100;
-                break;
-                
-            case RUBLE:
-                score += 50;
-                break;
-                
-            case ENERGY:
-                hasEnergyBoost = true;
-                energyTimer = ENERGY_DURATION;
-                roadSpeed = baseRoadSpeed * 1.2f;
-                obstacleSpeed = 300.0f * 1.2f;
-                break;
-                
-            case SEEDS:
-                hasSeedsBoost = true;
-                seedsTimer = SEEDS_DURATION;
-                scoreMultiplier = 2;
-                break;
-                
-            case MACASIN:
-                hasMacasinBoost = true;
-                macasinTimer = MACASIN_DURATION;
-                break;
-                
-            case MOPED:
-                if (mopedCount < MAX_MOPEDS) {
-                    mopedCount++;
-                }
-                break;
-        }
-    }
-    
-    // Проверка столкновений
-    void checkCollisions() {
-        FloatRect playerBounds;
-        
-        if (playerSprite) {
-            playerBounds = playerSprite->getGlobalBounds();
-        } else {
-            playerBounds = FloatRect({lanePositions[currentLane] + laneWidth/2 - 25, 500.0f - jumpHeight}, {50.0f, 50.0f});
-        }
-        
-        // Столкновения с бустами
-        for (auto& boost : boosts) {
-            if (boost.active) {
-                FloatRect boostBounds(boost.position, boost.size);
-                if (playerBounds.findIntersection(boostBounds).has_value()) {
-                    applyBoostEffect(boost.type);
-                    boost.active = false;
-                }
+            else if (keyPressed->scancode == Keyboard::Scan::D || keyPressed->scancode == Keyboard::Scan::Right) {
+                issueCommand(Command::LANE_RIGHT);
             }
-        }
-        
-        // Мопед активен - проверка на поломку
-        if (isMopedActive) {
-            bool collisionHappened = false;
-            for (const auto& obstacle : obstacles) {
-                FloatRect obstacleBounds(obstacle.position, obstacle.size);
-                if (playerBounds.findIntersection(obstacleBounds).has_value()) {
-                    collisionHappened = true;
-                    break;
-                }
+            else if (keyPressed->scancode == Keyboard::Scan::W || keyPressed->scancode == Keyboard::Scan::Space) {
+                issueCommand(Command::JUMP);
             }
-            
-            if (collisionHappened) {
-                isMopedActive = false;
-                mopedTimer = 0.0f;
-                mopedCooldown = 1.0f;
-                if (!runTextures.empty() && playerSprite) {
-                    playerSprite->setTexture(runTextures[currentFrame]);
-                }
+            else if (keyPressed->scancode == Keyboard::Scan::Q) {
+                issueCommand(Command::MOPED);
             }
-            return;
-        }
-        
-        // Задержка после поломки мопеда
-        if (mopedCooldown > 0.0f) {
-            return;
-        }
-        
-        // Макасин активен - логика прыжков
-        if (hasMacasinBoost) {
-            if (isJumping || isFalling) {
-                return;
+            else if (keyPressed->scancode == Keyboard::Scan::Escape) {
+                finishRecording();
+                currentState = MENU;
+                resetGame();
             }
-            for (const auto& obstacle : obstacles) {
-                FloatRect obstacleBounds(obstacle.position, obstacle.size);
-                if (playerBounds.findIntersection(obstacleBounds).has_value()) {
-                    currentState = GAME_OVER;
-                    return;
-                }
+            else if (keyPressed->scancode == Keyboard::Scan::R && currentState == GAME_OVER) {
+                currentState = PLAYING;
+                resetGame();
             }
-            return;
+            else if (keyPressed->scancode == Keyboard::Scan::F2 && !watchingReplay) {
+                // Переключение нагрузочного режима начинает забег заново
+                finishRecording();
+                stressLevel = stressLevel > 0 ? 0 : (options.stressLevel > 0 ? options.stressLevel : DEFAULT_STRESS_LEVEL);
+                currentState = PLAYING;
+                resetGame();
+            }
+            else if (keyPressed->scancode == Keyboard::Scan::F6 && !watchingReplay) {
+                autopilotEnabled.store(!autopilotEnabled.load());
+            }
+            else if (keyPressed->scancode == Keyboard::Scan::Backspace && !watchingReplay) {
+                startRewind();
+            }
+#ifdef RR_PROFILE
+            else if (keyPressed->scancode == Keyboard::Scan::F3 && profilerOverlay) {
+                profilerOverlay->visible = !profilerOverlay->visible;
+            }
+            else if (keyPressed->scancode == Keyboard::Scan::F4) {
+                dumpTrace();
+            }
+#endif
         }
         
-        // Обычная логика столкновений
-        if (isJumping || isFalling) {
-            for (const auto& obstacle : obstacles) {
-                FloatRect obstacleBounds(obstacle.position, obstacle.size);
-                if (obstacle.type == 1 && playerBounds.findIntersection(obstacleBounds).has_value()) {
-                    currentState = GAME_OVER;
-                    return;
-                }
-            }
-        } else {
-            for (const auto& obstacle : obstacles) {
-                FloatRect obstacleBounds(obstacle.position, obstacle.size);
-                if (playerBounds.findIntersection(obstacleBounds).has_value()) {
-                    currentState = GAME_OVER;
-                    return;
-                }
+        if (auto keyReleased = event.getIf<Event::KeyReleased>()) {
+            if (keyReleased->scancode == Keyboard::Scan::Backspace) {
+                rewinding.store(false);
             }
         }
     }
     
-    // Обновление таймеров бустов
-    void updateBoostTimers(float deltaTime) {
-        std::string boostText = "";
-        
-        // Задержка мопеда
-        if (mopedCooldown > 0.0f) {
-            mopedCooldown -= deltaTime;
-            if (mopedCooldown < 0.0f) {
-                mopedCooldown = 0.0f;
+    // Перемотка назад, пока зажат Backspace. С экрана Game Over забег
+    // возобновляется: первый шаг назад делается здесь, пока поток не запущен,
+    // чтобы мир уже не был проигран. Повтор такого забега не продолжается.
+    void startRewind() {
+        if (currentState == GAME_OVER) {
+            long long target = std::max(world.tick - REWIND_STEP_TICKS, rewind.oldestTick());
+            if (rewind.empty() || target >= world.tick || !rewind.restore(target, world)) {
+                return;
             }
+            currentState = PLAYING;
+            publishSnapshot(false);
+            startSimulation();
         }
-        
-        // Энергетик
-        if (hasEnergyBoost) {
-            energyTimer -= deltaTime;
-            int secondsLeft = static_cast<int>(energyTimer) + 1;
-            boostText += "ENERGY: " + std::to_string(secondsLeft) + "s ";
-            
-            if (energyTimer <= 0.0f) {
-                hasEnergyBoost = false;
-                roadSpeed = baseRoadSpeed;
-                obstacleSpeed = 300.0f;
-            }
+        rewinding.store(true);
+    }
+    
+    // Команда игрока уходит в поток симуляции; там она записывается в повтор
+    // и применяется к миру перед ближайшим тиком
+    void issueCommand(Command command) {
+        if (watchingReplay || currentState != PLAYING) {
+            return;
         }
-        
-        // Семечки
-        if (hasSeedsBoost) {
-            seedsTimer -= deltaTime;
-            int secondsLeft = static_cast<int>(seedsTimer) + 1;
-            boostText += "SEEDS: " + std::to_string(secondsLeft) + "s ";
-            
-            if (seedsTimer <= 0.0f) {
-                hasSeedsBoost = false;
-                scoreMultiplier = 1;
-            }
+        commands.push(command);
+    }
+    
+    // Сохранение повтора законченного забега в replays/ (симуляция останавливается)
+    void finishRecording() {
+        stopSimulation();
+        if (!recorder.isRecording()) {
+            return;
         }
+        recorder.finish(world);
         
-        // Макасин
-        if (hasMacasinBoost) {
-            macasinTimer -= deltaTime;
-            int secondsLeft = static_cast<int>(macasinTimer) + 1;
-            boostText += "MACASIN: " + std::to_string(secondsLeft) + "s ";
-            
-            if (macasinTimer <= 0.0f) {
-                hasMacasinBoost = false;
-            }
+        std::error_code error;
+        std::filesystem::create_directories("replays", error);
+        std::string path = "replays/run_" + std::to_string(world.seed) + ".rpl";
+        if (!recorder.save(path)) {
+            std::cout << "Could not save replay: " << path << std::endl;
         }
-        
-        // Мопед
-        if (isMopedActive) {
-            mopedTimer -= deltaTime;
-            int secondsLeft = static_cast<int>(mopedTimer) + 1;
-            boostText += "MOPED: " + std::to_string(secondsLeft) + "s ";
-            
-            if (mopedTimer <= 0.0f) {
-                isMopedActive = false;
+    }
+    
+    // Сброс игры; в состоянии PLAYING сразу запускается поток симуляции
+    void resetGame() {
+        stopSimulation();
+        
+        // Спутники не влияют на забег, поэтому их число можно менять и при просмотре повтора
+        world.followerCount = followerCount(options, stressLevel);
+        if (watchingReplay) {
+            replayReader.open(replayFile.data(), replayFile.size());
+            replayReader.getSummary().configure(world);
+            world.reset(replayReader.getSummary().seed);
+        } else {
+            // Забег под нагрузкой не записывается: настройки спавна не входят в повтор
+            world.spawnRate = stressLevel > 0 ? stressLevel : 1;
+            world.invulnerable = stressLevel > 0;
+            world.timeCollisions = stressLevel > 0;
+            world.generatedTrack = true;
+            world.legacyTiming = false;
+            world.reset(options.hasSeed ? options.seed : makeSeed());
+            if (currentState == PLAYING && stressLevel == 0) {
+                recorder.begin(world);
             }
         }
         
-        // Инвентарь мопедов
-        if (mopedCount > 0) {
-            boostText += "MOPEDx" + std::to_string(mopedCount) + " [Q] ";
+        // Первый кадр перемотки и первый снимок нового забега пишутся отсюда,
+        // пока поток не запущен
+        rewind.clear();
+        rewinding.store(false);
+        if (!watchingReplay) {
+            rewind.capture(world);
         }
-        
-        if (boostTimerText) {
-            boostTimerText->setString(boostText);
+        commands.clear();
+        publishSnapshot(false);
+        stressTick = 0;
+        stressStepSeconds = stepSeconds;
+        stressCollisionSeconds = world.collisionSeconds;
+        
+        if (currentState == PLAYING) {
+            startSimulation();
         }
     }
     
-    // Обработка ввода в игре
-    void handleGameInput() {
-        for (auto event = window.pollEvent(); event.has_value(); event = window.pollEvent()) {
-            if (event->is<Event::Closed>()) {
-                window.close();
-                return;
-            }
-            
-            if (auto keyPressed = event->getIf<Event::KeyPressed>()) {
-                if (keyPressed->scancode == Keyboard::Scan::A || keyPressed->scancode == Keyboard::Scan::Left) {
-                    if (currentLane > 0) {
-                        currentLane--;
+    void startSimulation() {
+        simulationStop.store(false);
+        simulationThread = std::thread(&RussiaRunner::simulate, this);
+    }
+    
+    void stopSimulation() {
+        if (simulationThread.joinable()) {
+            simulationStop.store(true);
+            simulationThread.join();
+        }
+    }
+    
+    // Длительность тика в реальном времени (повтор можно ускорить или замедлить)
+    float tickSeconds() const {
+        return watchingReplay ? TICK_DT / options.replaySpeed : TICK_DT;
+    }
+    
+    void publishSnapshot(bool finished) {
+        RenderSnapshot& snapshot = snapshots.writeSlot();
+        snapshot.capture(world);
+        snapshot.tickSeconds = tickSeconds();
+        snapshot.finished = finished;
+        snapshot.stepSeconds = stepSeconds;
+        snapshot.autopilot = autopilotEnabled.load(std::memory_order_relaxed);
+        snapshot.searchStatesPerSecond = autopilot.statesPerSecond();
+        snapshot.rewindSeconds = rewind.coveredSeconds();
+        snapshot.rewindBytes = rewind.bytesUsed();
+        snapshot.rewindCaptureSeconds = rewind.averageCaptureSeconds();
+        snapshots.publish();
+    }
+    
+    // Поток симуляции: команды из очереди, тик с фиксированным шагом, снимок для окна.
+    // Темп держит свой FramePacer; если поток отстал больше чем на тик, отсчет
+    // начинается заново, а не догоняет пачкой тиков.
+    void simulate() {
+        FramePacer tickPacer;
+        tickPacer.setTargetFps(static_cast<int>(std::lround(1.0f / tickSeconds())));
+        
+        while (!simulationStop.load(std::memory_order_acquire)) {
+            bool finished = false;
+            {
+                RR_PROFILE_ZONE("simulate");
+                auto stepStart = std::chrono::steady_clock::now();
+                
+                Command command;
+                if (rewinding.load(std::memory_order_relaxed) && !watchingReplay) {
+                    // Перемотка: нажатия не применяются, мир идет назад по сохраненным тикам
+                    while (commands.pop(command)) {
+                        // Нажатия во время перемотки пропускаются
                     }
-                    updatePlayerPosition();
-                }
-                else if (keyPressed->scancode == Keyboard::Scan::D || keyPressed->scancode == Keyboard::Scan::Right) {
-                    if (currentLane < 2) {
-                        currentLane++;
+                    long long target = std::max(world.tick - REWIND_STEP_TICKS, rewind.oldestTick());
+                    if (target < world.tick && rewind.restore(target, world)) {
+                        recorder.rewind(world.tick);
                     }
-                    updatePlayerPosition();
-                }
-                else if (keyPressed->scancode == Keyboard::Scan::W || keyPressed->scancode == Keyboard::Scan::Space) {
-                    if (!isJumping && !isFalling) {
-                        isJumping = true;
-                        jumpHeight = 0.0f;
+                } else {
+                    while (commands.pop(command)) {
+                        if (!world.gameOver) {
+                            recorder.record(world.tick, command);
+                            world.applyCommand(command);
+                        }
+                    }
+                    
+                    if (watchingReplay) {
+                        replayReader.feed(world);
+                        finished = replayReader.finished(world);
+                    } else if (autopilotEnabled.load(std::memory_order_relaxed) && autopilot.choose(world, command)) {
+                        recorder.record(world.tick, command);
+                        world.applyCommand(command);
+                    }
+                    if (!finished) {
+                        world.step();
+                        finished = world.gameOver || (watchingReplay && replayReader.finished(world));
+                        if (!watchingReplay) {
+                            rewind.capture(world);
+                        }
                     }
                 }
-                else if (keyPressed->scancode == Keyboard::Scan::Q && mopedCount > 0 && !isMopedActive) {
-                    isMopedActive = true;
-                    mopedTimer = MOPED_DURATION;
-                    mopedCount--;
-                }
-                else if (keyPressed->scancode == Keyboard::Scan::Escape) {
-                    currentState = MENU;
-                    resetGame();
-                }
-                else if (keyPressed->scancode == Keyboard::Scan::R && currentState == GAME_OVER) {
-                    currentState = PLAYING;
-                    resetGame();
-                }
+                
+                stepSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - stepStart).count();
+                publishSnapshot(finished);
+            }
+            if (finished) {
+                return;
             }
+            tickPacer.wait();
         }
     }
     
-    // Сброс игры
-    void resetGame() {
-        obstacles.clear();
-        boosts.clear();
-        currentLane = 1;
-        isJumping = false;
-        isFalling = false;
-        jumpHeight = 0.0f;
-        score = 0;
-        scoreMultiplier = 1;
-        scoreClock.restart();
-        roadOffset = 0.0f;
-        roadSpeed = baseRoadSpeed;
-        obstacleSpeed = 300.0f;
+    // Последний снимок забега: поток симуляции уже закончил, показываем итог
+    void finishRun(const RenderSnapshot& snapshot) {
+        finishRecording();
+        currentState = GAME_OVER;
+        gameOverScreen.setString(finalScoreItem, "Final Score: " + std::to_string(snapshot.score));
+    }
+    
+    // Отрисовка игры по снимку
+    void renderGame(const RenderSnapshot& snapshot) {
+        RR_PROFILE_ZONE("renderGame");
+        auto renderStart = std::chrono::steady_clock::now();
         
-        hasEnergyBoost = false;
-        energyTimer = 0.0f;
-        hasSeedsBoost = false;
-        seedsTimer = 0.0f;
-        hasMacasinBoost = false;
-        macasinTimer = 0.0f;
+        // Интерполяция между прошлым и последним тиком по времени с момента снимка
+        float alpha = snapshot.alphaAt(renderStart);
+        float scrollShift = snapshot.renderScrollShift(alpha);
         
-        mopedCount = 1;
-        isMopedActive = false;
-        mopedTimer = 0.0f;
-        mopedCooldown = 0.0f;
-        mopedRideFrame = 0;
-        mopedRideAnimationTimer = 0.0f;
+        // Поле рисуется во внутренний холст (или прямо в окно на 100%),
+        // тексты поверх - в окно в его разрешении
+        window.clear(Color(100, 100, 100));
+        RenderTarget& field = playfield.begin(window, Color(100, 100, 100));
         
-        currentFrame = 0;
-        animationTimer = 0.0f;
+        // Отрисовка дороги
+        roadRenderer.setOffset(snapshot.renderRoadOffset(alpha));
+        roadRenderer.setHighlightedLane(snapshot.playerLane);
+        roadRenderer.draw(field);
         
-        // Сброс спутника
-        followerLane = 1;
-        followerIsJumping = false;
-        followerIsFalling = false;
-        followerJumpHeight = 0.0f;
-        followerCurrentFrame = 0;
-        followerAnimationTimer = 0.0f;
-        followerActionTimer = 0.0f;
-        followerNeedsToJump = false;
-        followerTargetLane = 1;
+        batch.begin();
         
-        if (!runTextures.empty() && playerSprite) {
-            playerSprite->setTexture(runTextures[0]);
+        // Препятствия
+        for (const auto& obstacle : snapshot.obstacles) {
+            batchEntity(obstacleRects[obstacle.type], obstacleColors[obstacle.type],
+                        FloatRect({obstacle.x, obstacle.y + scrollShift}, {obstacle.w, obstacle.h}));
         }
         
-        if (!followerRunTextures.empty() && followerSprite) {
-            followerSprite->setTexture(followerRunTextures[0]);
+        // Бусты
+        for (const auto& boost : snapshot.boosts) {
+            batchEntity(boostRects[boost.type], boostColors[boost.type],
+                        FloatRect({boost.x, boost.y + scrollShift}, {boost.w, boost.h}));
         }
         
-        if (scoreText) {
-            scoreText->setString("Score: 0");
+        // Спутники (позади игрока)
+        if (!followerRunFrames.empty()) {
+            for (const auto& follower : snapshot.followers) {
+                IntRect frame = followerRunFrames[follower.frame];
+                batch.addSprite(0, frame, FloatRect({follower.x, follower.renderY(alpha)},
+                                                    {frame.size.x * 0.8f, frame.size.y * 0.8f}));
+            }
         }
         
-        if (boostTimerText) {
-            boostTimerText->setString("");
+        // Игрок
+        const auto& player = snapshot.player;
+        IntRect frame = playerFrame(snapshot);
+        if (frame.size.x > 0) {
+            batch.addSprite(0, frame, FloatRect({player.x, player.renderY(alpha)},
+                                                {frame.size.x * 0.8f, frame.size.y * 0.8f}), playerTint(snapshot));
+        } else {
+            batch.addRect(0, FloatRect({player.x, player.renderY(alpha)}, {50.0f, 50.0f}), playerFallbackColor(snapshot));
         }
         
-        updatePlayerPosition();
-        updateFollowerPosition();
-        spawnClock.restart();
-        boostSpawnClock.restart();
-        firstFrame = true;
-    }
-    
-    // Основное обновление игры
-    void update(float deltaTime) {
-        // Анимация бега
-        if (!runTextures.empty() && playerSprite) {
-            animationTimer += deltaTime;
-            if (animationTimer >= frameTime) {
-                currentFrame = (currentFrame + 1) % runTextures.size();
-                if (!isMopedActive) {
-                    playerSprite->setTexture(runTextures[currentFrame]);
-                }
-                animationTimer = 0.0f;
-            }
-        }
+        batch.flush(field);
+        playfield.present(window);
         
-        // Анимация мопеда
-        if (isMopedActive && !mopedRideTextures.empty()) {
-            mopedRideAnimationTimer += deltaTime;
-            if (mopedRideAnimationTimer >= mopedRideFrameTime) {
-                mopedRideFrame = (mopedRideFrame + 1) % mopedRideTextures.size();
-                playerSprite->setTexture(mopedRideTextures[mopedRideFrame]);
-                mopedRideAnimationTimer = 0.0f;
-            }
+        if (hud) {
+            hud->draw(window);
         }
         
-        // Движение дороги
-        roadOffset += roadSpeed * deltaTime;
-        if (roadOffset >= roadTexture.getSize().y * 0.25f) {
-            roadOffset = 0.0f;
+        if (stressLevel > 0) {
+            stressRenderSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - renderStart).count();
+            drawStressOverlay(snapshot);
         }
         
-        // Прыжок
-        if (isJumping) {
-            jumpHeight += jumpSpeed * deltaTime;
-            if (jumpHeight >= maxJumpHeight) {
-                isJumping = false;
-                isFalling = true;
-            }
-            updatePlayerPosition();
+#ifdef RR_PROFILE
+        if (profilerOverlay) {
+            profilerOverlay->draw(window);
         }
-        else if (isFalling) {
-            jumpHeight -= jumpSpeed * deltaTime;
-            if (jumpHeight <= 0.0f) {
-                isFalling = false;
-                jumpHeight = 0.0f;
-            }
-            updatePlayerPosition();
-        }
-        
-        // Обновление спутника
-        updateFollower(deltaTime);
-        
-        // Обновление счета
-        if (scoreClock.getElapsedTime().asSeconds() >= 1.0f) {
-            score += 10 * scoreMultiplier;
-            scoreClock.restart();
-            
-            if (scoreText) {
-                scoreText->setString("Score: " + std::to_string(score));
-            }
+#endif
+    }
+    
+#ifdef RR_PROFILE
+    // Запись трассы последних 10 секунд для chrome://tracing
+    void dumpTrace() {
+        std::error_code error;
+        std::filesystem::create_directories("traces", error);
+        std::string path = "traces/trace_" + std::to_string(makeSeed()) + ".json";
+        if (Profiler::instance().dumpTrace(path, 10.0)) {
+            std::cout << "Trace saved: " << path << std::endl;
+        } else {
+            std::cout << "Could not save trace: " << path << std::endl;
         }
-        
-        spawnObstacle();
-        spawnBoost();
-        updateObstacles(deltaTime);
-        updateBoosts(deltaTime);
-        updateBoostTimers(deltaTime);
-        checkCollisions();
     }
     
-    // Отрисовка игры
-    void renderGame() {
-        window.clear(Color(100, 100, 100));
-        
-        // Отрисовка дороги
-        if (roadTexture.getSize().x > 0) {
-            Vector2u originalRoadSize = roadTexture.getSize();
-            float scaleFactor = 0.25f;
-            Vector2f roadSpriteSize = {originalRoadSize.x * scaleFactor, originalRoadSize.y * scaleFactor};
-            
-            for (int i = 0; i < 3; ++i) {
-                int tilesNeeded = static_cast<int>(600.0f / roadSpriteSize.y) + 2;
-                for (int j = -1; j < tilesNeeded; ++j) {
-                    Sprite roadSprite(roadTexture);
-                    float posX = lanePositions[i] + 1.0f;
-                    float posY = static_cast<float>(j) * roadSpriteSize.y + roadOffset;
-                    roadSprite.setPosition({posX, posY});
-                    float scaleX = (laneWidth - 2.0f) / originalRoadSize.x;
-                    roadSprite.setScale({scaleX, scaleFactor});
-                    window.draw(roadSprite);
-                }
+#endif
+    // Счетчики нагрузочного режима: средние за четверть секунды.
+    // Тики и кадры идут в разных потоках, поэтому время тика считается по тикам,
+    // а время отрисовки - по кадрам.
+    void drawStressOverlay(const RenderSnapshot& snapshot) {
+        stressFrames++;
+        float elapsed = stressClock.getElapsedTime().asSeconds();
+        if (elapsed >= 0.25f) {
+            long long ticks = std::max(snapshot.tick - stressTick, 1LL);
+            char search[64] = "";
+            if (snapshot.autopilot) {
+                std::snprintf(search, sizeof(search), "  autopilot %.0f states/s", snapshot.searchStatesPerSecond);
             }
-        } else {
-            for (int i = 0; i < 3; ++i) {
-                RectangleShape lane({laneWidth - 2.0f, 600.0f});
-                lane.setPosition({lanePositions[i] + 1.0f, 0.0f});
-                lane.setFillColor(i == currentLane ? Color(150, 150, 150) : Color(120, 120, 120));
-                window.draw(lane);
+            char line[512];
+            std::snprintf(line, sizeof(line),
+                          "STRESS x%d  obstacles %zu  boosts %zu  followers %zu  quads %zu  draws %zu\n"
+                          "tick %.3f ms  collisions %.3f ms  render %.3f ms\n"
+                          "rewind %.1f s in %zu KB  capture %.3f ms\n"
+                          "field %ux%u (%d%%)  %.0f ticks/s  %.0f fps%s",
+                          stressLevel, snapshot.obstacles.size(), snapshot.boosts.size(), snapshot.followers.size(),
+                          batch.getQuadCount(), batch.getDrawCalls(),
+                          (snapshot.stepSeconds - stressStepSeconds) * 1000.0 / ticks,
+                          (snapshot.collisionSeconds - stressCollisionSeconds) * 1000.0 / ticks,
+                          stressRenderSeconds * 1000.0 / stressFrames,
+                          snapshot.rewindSeconds, snapshot.rewindBytes / 1024, snapshot.rewindCaptureSeconds * 1000.0,
+                          playfield.getPixelSize().x, playfield.getPixelSize().y, renderScale,
+                          (snapshot.tick - stressTick) / elapsed, stressFrames / elapsed, search);
+            if (stressText) {
+                stressText->setString(line);
             }
+            
+            stressFrames = 0;
+            stressRenderSeconds = 0.0;
+            stressTick = snapshot.tick;
+            stressStepSeconds = snapshot.stepSeconds;
+            stressCollisionSeconds = snapshot.collisionSeconds;
+            stressClock.restart();
         }
         
-        // Отрисовка препятствий
-        for (const auto& obstacle : obstacles) {
-            if (obstacle.type == 0 && benchTexture.getSize().x > 0) {
-                Sprite benchSprite(benchTexture);
-                Vector2u texSize = benchTexture.getSize();
-                float scaleX = obstacle.size.x / texSize.x;
-                float scaleY = obstacle.size.y / texSize.y;
-                benchSprite.setScale({scaleX, scaleY});
-                benchSprite.setPosition(obstacle.position);
-                window.draw(benchSprite);
-            } else if (obstacle.type == 1 && garageTexture.getSize().x > 0) {
-                Sprite garageSprite(garageTexture);
-                Vector2u texSize = garageTexture.getSize();
-                float scaleX = obstacle.size.x / texSize.x;
-                float scaleY = obstacle.size.y / texSize.y;
-                garageSprite.setScale({scaleX, scaleY});
-                garageSprite.setPosition(obstacle.position);
-                window.draw(garageSprite);
-            } else {
-                RectangleShape obstacleShape(obstacle.size);
-                obstacleShape.setFillColor(obstacle.type == 0 ? Color::Green : Color::Red);
-                obstacleShape.setPosition(obstacle.position);
-                window.draw(obstacleShape);
-            }
+        if (stressText) {
+            window.draw(*stressText);
         }
-        
-        // Отрисовка бустов
-        for (const auto& boost : boosts) {
-            if (boost.active) {
-                Texture* currentTexture = nullptr;
-                Color fallbackColor;
+    }
+    
+    // Отрисовка Game Over
+    void renderGameOver() {
+        gameOverScreen.draw(window);
+        window.display();
+    }
+    
+    // Обработка события статичного экрана
+    void handleScreenEvent(const Event& event) {
+        GameState previousState = currentState;
+        handleWindowEvent(event);
+        switch (currentState) {
+            case MENU:
+                handleMenuEvent(event);
+                break;
                 
-                switch (boost.type) {
-                    case BEER:
-                        currentTexture = &beerTexture;
-                        fallbackColor = Color(255, 200, 0);
-                        break;
-                    case RUBLE:
-                        currentTexture = &rubleTexture;
-                        fallbackColor = Color::Green;
-                        break;
-                    case ENERGY:
-                        currentTexture = &energyTexture;
-                        fallbackColor = Color::Red;
+            case CONTROLS:
+                handleControlsEvent(event);
+                break;
+                
+            case GAME_OVER:
+                handleGameEvent(event);
+                break;
+                
+            case PLAYING:
+                break;
+        }
+        
+        // Окно могло потерять содержимое: кадр нужно показать заново
+        if (currentState != previousState || event.is<Event::Resized>() || event.is<Event::FocusGained>()) {
+            screenChanged = true;
+        }
+    }
+    
+    // Главный цикл игры
+    void run() {
+        while (window.isOpen()) {
+            if (currentState == PLAYING) {
+                handleGameInput();
+                if (currentState == PLAYING) {
+                    snapshots.update();
+                    const RenderSnapshot& snapshot = snapshots.readSlot();
+                    if (snapshot.finished) {
+                        finishRun(snapshot);
+                    } else {
+                        // Счет и таймеры бустов: текст меняется только при смене чисел
+                        if (hud) {
+                            hud->update(snapshot);
+                        }
+                        renderGame(snapshot);
+                        {
+                            RR_PROFILE_ZONE("display");
+                            window.display();
+                        }
+                        pacer.wait();
+                        RR_PROFILE_FRAME();
+                    }
+                }
+                screenChanged = true;
+                continue;
+            }
+            
+            // Статичные экраны: кадр выводится только после изменений,
+            // а между событиями поток спит в waitEvent
+            if (screenChanged) {
+                screenChanged = false;
+                switch (currentState) {
+                    case MENU:
+                        renderMenu();
                         break;
-                    case SEEDS:
-                        currentTexture = &seedsTexture;
-                        fallbackColor = Color::Cyan;
+                        
+                    case CONTROLS:
+                        renderControls();
                         break;
-                    case MACASIN:
-                        currentTexture = &macasinTexture;
-                        fallbackColor = Color::Magenta;
+                        
+                    case GAME_OVER:
+                        renderGameOver();
                         break;
-                    case MOPED:
-                        currentTexture = &mopedItemTexture;
-                        fallbackColor = Color(150, 150, 150);
+                        
+                    case PLAYING:
                         break;
                 }
-                
-                if (currentTexture && currentTexture->getSize().x > 0) {
-                    Sprite boostSprite(*currentTexture);
-                    Vector2u texSize = currentTexture->getSize();
-                    float scaleX = boost.size.x / texSize.x;
-                    float scaleY = boost.size.y / texSize.y;
-                    boostSprite.setScale({scaleX, scaleY});
-                    boostSprite.setPosition(boost.position);
-                    window.draw(boostSprite);
-                } else {
-                    RectangleShape boostShape(boost.size);
-                    boostShape.setFillColor(fallbackColor);
-                    boostShape.setPosition(boost.position);
-                    window.draw(boostShape);
+            }
+            
+            if (auto event = window.waitEvent()) {
+                handleScreenEvent(*event);
+                while (currentState != PLAYING && window.isOpen()) {
+                    auto pending = window.pollEvent();
+                    if (!pending) {
+                        break;
+                    }
+                    handleScreenEvent(*pending);
                 }
             }
+            pacer.reset();
         }
         
-        // Отрисовка спутника (позади игрока)
-        if (followerSprite) {
-            window.draw(*followerSprite);
+        const FramePacingStats& stats = pacer.getStats();
+        if (stats.frames > 0 && pacer.isLimited()) {
+            std::cout << "Frames: " << stats.frames << ", missed deadlines: " << stats.missed
+                      << " (worst " << stats.worstLateMs << " ms, average "
+                      << (stats.missed > 0 ? stats.totalLateMs / stats.missed : 0.0) << " ms)" << std::endl;
         }
-        
-        if (scoreText) {
-            window.draw(*scoreText);
+    }
+};
+
+// Проверка повторов без окна: файл или все .rpl в папке
+int verifyReplays(const std::string& path) {
+    std::vector<std::string> files;
+    std::error_code error;
+    if (std::filesystem::is_directory(path, error)) {
+        for (const auto& entry : std::filesystem::directory_iterator(path, error)) {
+            if (entry.path().extension() == ".rpl") {
+                files.push_back(entry.path().string());
+            }
         }
-        
-        if (boostTimerText) {
-            window.draw(*boostTimerText);
+        std::sort(files.begin(), files.end());
+    } else {
+        files.push_back(path);
+    }
+    
+    GameWorld world;
+    int failed = 0;
+    long long totalTicks = 0;
+    auto start = std::chrono::steady_clock::now();
+    
+    for (const auto& file : files) {
+        MappedFile mapped;
+        ReplayCheck check;
+        if (mapped.open(file)) {
+            check = verifyReplay(mapped.data(), mapped.size(), world);
         }
-        
-        if (playerSprite) {
-            // Визуальные эффекты бустов
-            if (isMopedActive) {
-                if (static_cast<int>(mopedTimer * 10) % 2 == 0) {
-                    playerSprite->setColor(Color(100, 100, 255, 200));
-                } else {
-                    playerSprite->setColor(Color(200, 200, 255, 150));
-                }
-            }
-            else if (hasEnergyBoost && static_cast<int>(energyTimer * 10) % 2 == 0) {
-                playerSprite->setColor(Color(255, 100, 100));
-            } else if (hasSeedsBoost && static_cast<int>(seedsTimer * 10) % 2 == 0) {
-                playerSprite->setColor(Color(100, 255, 255));
-            } else if (hasMacasinBoost && static_cast<int>(macasinTimer * 10) % 2 == 0) {
-                playerSprite->setColor(Color(255, 100, 255));
-            } else {
-                playerSprite->setColor(Color::White);
-            }
-            window.draw(*playerSprite);
-        } else {
-            RectangleShape playerShape({50.0f, 50.0f});
-            if (isMopedActive) {
-                playerShape.setFillColor(Color::Blue);
-            } else if (hasEnergyBoost) {
-                playerShape.setFillColor(Color::Red);
-            } else if (hasSeedsBoost) {
-                playerShape.setFillColor(Color::Cyan);
-            } else if (hasMacasinBoost) {
-                playerShape.setFillColor(Color::Magenta);
-            } else {
-                playerShape.setFillColor(Color::Blue);
+        totalTicks += check.actual.endTick;
+        
+        if (!check.valid) {
+            std::cout << file << ": INVALID\n";
+            failed++;
+        } else if (!check.matches) {
+            std::cout << file << ": MISMATCH (expected score " << check.expected.score
+                      << " at tick " << check.expected.endTick << ", got " << check.actual.score
+                      << " at tick " << check.actual.endTick << ")\n";
+            failed++;
+        } else if (files.size() == 1) {
+            std::cout << file << ": OK (seed " << check.expected.seed << ", score " << check.actual.score
+                      << ", " << (check.actual.died ? "died" : "quit") << " at tick " << check.actual.endTick << ")\n";
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Replays: " << files.size() << ", failed: " << failed << "\n";
+    std::cout << "Ticks per second: " << (seconds > 0.0 ? totalTicks / seconds : 0.0) << std::endl;
+    return failed == 0 && !files.empty() ? 0 : 1;
+}
+
+// Пакетный прогон (--batch N): все сочетания диапазонов баланса, по N забегов
+// на каждое, на всех ядрах; итог - CSV или JSON (по расширению --report)
+int runBatchReport(const Options& options) {
+    BatchJob job;
+    job.gamesPerConfig = options.batchGames;
+    job.seed = options.hasSeed ? options.seed : makeSeed();
+    job.maxTicks = options.maxGameTicks;
+    job.policyName = options.policy;
+    job.policy = findInputPolicy(options.policy);
+    if (!job.policy) {
+        std::cout << "Unknown policy: " << options.policy << " (available:";
+        for (const auto& entry : INPUT_POLICIES) {
+            std::cout << " " << entry.name;
+        }
+        std::cout << ")" << std::endl;
+        return 1;
+    }
+    
+    std::vector<std::vector<int>> weightSets = options.boostWeights;
+    if (weightSets.empty()) {
+        weightSets.push_back(std::vector<int>(BOOST_TYPE_COUNT, 1));
+    }
+    const SweepRange& obstacles = options.obstacleTicks;
+    const SweepRange& boosts = options.boostTicks;
+    for (int obstacleTicks = obstacles.from; obstacleTicks <= obstacles.to; obstacleTicks += obstacles.step) {
+        for (int boostTicks = boosts.from; boostTicks <= boosts.to; boostTicks += boosts.step) {
+            for (const auto& weights : weightSets) {
+                BatchConfig config;
+                config.obstacleSpawnTicks = obstacleTicks;
+                config.boostSpawnTicks = boostTicks;
+                std::copy(weights.begin(), weights.end(), config.boostWeights);
+                job.configs.push_back(config);
             }
-            playerShape.setPosition({lanePositions[currentLane] + laneWidth/2 - 25, 500.0f - jumpHeight});
-            window.draw(playerShape);
         }
-        
-        window.display();
     }
     
-    // Отрисовка Game Over
-    void renderGameOver() {
-        window.clear(Color(30, 0, 0));
-        
-        Text gameOverText(font, "GAME OVER!", 40);
-        gameOverText.setFillColor(Color::Red);
-        gameOverText.setPosition({180.0f, 150.0f});
-        
-        Text scoreText(font, "Final Score: " + std::to_string(score), 35);
-        scoreText.setFillColor(Color::Yellow);
-        scoreText.setPosition({170.0f, 220.0f});
-        
-        Text restartText(font, "Press R for restart", 30);
-        restartText.setFillColor(Color::White);
-        restartText.setPosition({190.0f, 300.0f});
-        
-        Text menuText(font, "ESC for escape to menu", 30);
-        menuText.setFillColor(Color::White);
-        menuText.setPosition({170.0f, 350.0f});
-        
-        window.draw(gameOverText);
-        window.draw(scoreText);
-        window.draw(restartText);
-        window.draw(menuText);
-        
-        window.display();
+    WorkStealingPool pool(options.threads > 0 ? options.threads : std::thread::hardware_concurrency());
+    std::cout << "Seed: " << job.seed << "\n";
+    std::cout << "Policy: " << job.policyName << "\n";
+    std::cout << "Configs: " << job.configs.size() << " x " << job.gamesPerConfig << " games on "
+              << pool.size() << " threads" << std::endl;
+    
+    BatchReport report = runBatch(job, pool);
+    
+    std::ofstream out(options.reportPath);
+    if (!out) {
+        std::cout << "Cannot write " << options.reportPath << std::endl;
+        return 1;
+    }
+    if (std::filesystem::path(options.reportPath).extension() == ".json") {
+        writeBatchJson(out, job, report);
+    } else {
+        writeBatchCsv(out, report);
     }
     
-    // Главный цикл игры
-    void run() {
-        Clock clock;
-        
-        while (window.isOpen()) {
-            float deltaTime = clock.restart().asSeconds();
-            
-            switch (currentState) {
-                case MENU:
-                    handleMenuInput();
-                    renderMenu();
-                    break;
-                    
-                case PLAYING:
-                    handleGameInput();
-                    update(deltaTime);
-                    renderGame();
-                    break;
-                    
-                case CONTROLS:
-                    handleControlsInput();
-                    renderControls();
-                    break;
-                    
-                case GAME_OVER:
-                    handleGameInput();
-                    renderGameOver();
-                    break;
+    double games = static_cast<double>(job.configs.size()) * job.gamesPerConfig;
+    std::cout << "Time: " << report.seconds << " s\n";
+    std::cout << "Games per second: " << (report.seconds > 0.0 ? games / report.seconds : 0.0) << "\n";
+    std::cout << "Ticks per second: " << (report.seconds > 0.0 ? report.totalTicks / report.seconds : 0.0) << "\n";
+    std::cout << "Report: " << options.reportPath << std::endl;
+    return 0;
+}
+
+// Разбор диапазона "A", "A:B" или "A:B:STEP"; значения не меньше 1
+SweepRange parseSweepRange(const char* text) {
+    SweepRange range;
+    int count = std::sscanf(text, "%d:%d:%d", &range.from, &range.to, &range.step);
+    if (count < 2) {
+        range.to = range.from;
+    }
+    if (count < 3) {
+        range.step = 1;
+    }
+    range.from = std::max(range.from, 1);
+    range.to = std::max(range.to, range.from);
+    range.step = std::max(range.step, 1);
+    return range;
+}
+
+// Разбор весов бустов "w0,w1,...": недостающие веса равны 1
+std::vector<int> parseBoostWeights(const char* text) {
+    std::vector<int> weights(BOOST_TYPE_COUNT, 1);
+    const char* cursor = text;
+    for (int type = 0; type < BOOST_TYPE_COUNT && *cursor; ++type) {
+        weights[type] = std::max(0, std::atoi(cursor));
+        cursor = std::strchr(cursor, ',');
+        if (!cursor) {
+            break;
+        }
+        cursor++;
+    }
+    return weights;
+}
+
+// Упаковка всех PNG из spryte/ в assets.pack: картинки декодируются один раз здесь,
+// а игра потом берет пиксели прямо из отображенного в память файла
+int packAssets() {
+    AssetLoader loader;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator(ASSET_DIRECTORY, error)) {
+        if (entry.path().extension() == ".png") {
+            loader.add(entry.path().stem().string(), entry.path().string());
+        }
+    }
+    loader.start();
+    loader.wait();
+    
+    std::vector<AssetPackImage> images;
+    loader.forEachLoaded([&images](const std::string& name, Image& image) {
+        images.push_back({name, image.getSize().x, image.getSize().y, image.getPixelsPtr()});
+    });
+    std::sort(images.begin(), images.end(), [](const AssetPackImage& a, const AssetPackImage& b) {
+        return a.name < b.name;
+    });
+    
+    if (images.size() != loader.total()) {
+        std::cout << "Could not decode " << loader.total() - images.size() << " of " << loader.total() << " images" << std::endl;
+    }
+    if (images.empty() || !writeAssetPack(ASSET_PACK_PATH, images)) {
+        std::cout << "Could not write " << ASSET_PACK_PATH << std::endl;
+        return 1;
+    }
+    std::cout << "Packed " << images.size() << " images into " << ASSET_PACK_PATH << std::endl;
+    return 0;
+}
+
+// Прогон симуляции без окна так быстро, как позволяет процессор
+int runHeadless(const Options& options) {
+    const long long ticks = options.ticks;
+    std::uint64_t seed = options.hasSeed ? options.seed : makeSeed();
+    std::cout << "Seed: " << seed << "\n";
+    
+    // Забеги идут подряд с seed, seed + 1, ...
+    TrackFeed trackFeed;
+    GameWorld world;
+    world.trackFeed = &trackFeed;
+    if (options.stressLevel > 0) {
+        world.spawnRate = options.stressLevel;
+        world.invulnerable = true;
+        world.timeCollisions = true;
+        std::cout << "Stress level: " << options.stressLevel << "\n";
+    }
+    world.followerCount = followerCount(options, options.stressLevel);
+    world.reset(seed);
+    std::cout << "Followers: " << world.followers().size() << "\n";
+    long long runs = 0;
+    long long totalScore = 0;
+    int bestScore = 0;
+    std::size_t peakObstacles = 0;
+    std::size_t peakBoosts = 0;
+    
+    // --rewind N: захват перемотки на каждом тике, чтобы замерить его цену
+    RewindBuffer rewind;
+    if (options.hasRewind) {
+        rewind.configure(static_cast<std::size_t>(options.rewindSeconds) * TICK_RATE + 1, REWIND_BUDGET_BYTES);
+    }
+    
+    // --autopilot играет вместо пустого ввода; с --record каждый забег
+    // сохраняется повтором (так получаются эталонные забеги автопилота)
+    Autopilot autopilot;
+    ReplayRecorder recorder;
+    std::error_code error;
+    auto saveRun = [&]() {
+        recorder.finish(world);
+        recorder.save(options.recordPath + "/run_" + std::to_string(world.seed) + ".rpl");
+    };
+    // Забег под нагрузкой не записывается: настройки спавна и бессмертие не входят в повтор
+    if (!options.recordPath.empty() && options.stressLevel > 0) {
+        std::cerr << "Stress runs are not recorded: --record ignored with --stress" << std::endl;
+    } else if (!options.recordPath.empty()) {
+        std::filesystem::create_directories(options.recordPath, error);
+        recorder.begin(world);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    for (long long tick = 0; tick < ticks; ++tick) {
+        Command command;
+        if (options.autopilot && autopilot.choose(world, command)) {
+            recorder.record(world.tick, command);
+            world.applyCommand(command);
+        }
+        world.step();
+        if (options.hasRewind) {
+            rewind.capture(world);
+        }
+        peakObstacles = std::max(peakObstacles, world.obstacles().size());
+        peakBoosts = std::max(peakBoosts, world.boosts().size());
+        if (world.gameOver) {
+            runs++;
+            totalScore += world.score;
+            bestScore = std::max(bestScore, world.score);
+            bool recording = recorder.isRecording();
+            if (recording) {
+                saveRun();
+            }
+            world.reset(seed + runs);
+            if (recording) {
+                recorder.begin(world);
             }
         }
     }
-};
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (recorder.isRecording()) {
+        saveRun();
+    }
+    
+    std::cout << "Ticks: " << ticks << " (" << ticks / TICK_RATE << " s of game time)\n";
+    std::cout << "Time: " << seconds << " s\n";
+    std::cout << "Ticks per second: " << (seconds > 0.0 ? ticks / seconds : 0.0) << "\n";
+    std::cout << "Runs finished: " << runs << "\n";
+    std::cout << "Best score: " << bestScore << "\n";
+    std::cout << "Average score: " << (runs > 0 ? static_cast<double>(totalScore) / runs : 0.0) << "\n";
+    std::cout << "Peak obstacles: " << peakObstacles << ", peak boosts: " << peakBoosts << std::endl;
+    if (world.usesTrack()) {
+        std::cout << "Track chunks built in place: " << trackFeed.builtInPlace << std::endl;
+    }
+    if (options.stressLevel > 0 && ticks > 0) {
+        std::cout << "Step time: " << seconds * 1e6 / ticks << " us, collisions: "
+                  << world.collisionSeconds * 1e6 / ticks << " us" << std::endl;
+    }
+    if (options.hasRewind) {
+        std::cout << "Rewind: " << rewind.coveredSeconds() << " s in " << rewind.bytesUsed() / 1024 << " KB ("
+                  << rewind.frameCount() << " frames), capture " << rewind.averageCaptureSeconds() * 1e6 << " us" << std::endl;
+    }
+    if (options.autopilot) {
+        std::cout << "Autopilot states evaluated: " << autopilot.statesEvaluated << "\n";
+        std::cout << "Autopilot states per second: " << autopilot.statesPerSecond() << std::endl;
+    }
+    return 0;
+}
 
-int main() {
-    RussiaRunner game;
+int main(int argc, char* argv[]) {
+    Options options;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--ticks" && i + 1 < argc) {
+            options.ticks = std::atoll(argv[++i]);
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.hasSeed = true;
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--replay" && i + 1 < argc) {
+            options.replayPath = argv[++i];
+        } else if (arg == "--speed" && i + 1 < argc) {
+            options.replaySpeed = std::max(0.1f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--stress" && i + 1 < argc) {
+            options.stressLevel = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--followers" && i + 1 < argc) {
+            options.hasFollowers = true;
+            options.followers = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--batch" && i + 1 < argc) {
+            options.batchGames = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--policy" && i + 1 < argc) {
+            options.policy = argv[++i];
+        } else if (arg == "--obstacle-ticks" && i + 1 < argc) {
+            options.obstacleTicks = parseSweepRange(argv[++i]);
+        } else if (arg == "--boost-ticks" && i + 1 < argc) {
+            options.boostTicks = parseSweepRange(argv[++i]);
+        } else if (arg == "--boost-weights" && i + 1 < argc) {
+            options.boostWeights.push_back(parseBoostWeights(argv[++i]));
+        } else if (arg == "--max-ticks" && i + 1 < argc) {
+            options.maxGameTicks = std::max(1LL, std::atoll(argv[++i]));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            options.threads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--report" && i + 1 < argc) {
+            options.reportPath = argv[++i];
+        } else if (arg == "--autopilot") {
+            options.autopilot = true;
+        } else if (arg == "--rewind" && i + 1 < argc) {
+            options.hasRewind = true;
+            options.rewindSeconds = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--record" && i + 1 < argc) {
+            options.recordPath = argv[++i];
+        } else if (arg == "--pack") {
+            options.packAssets = true;
+        } else if (arg == "--vsync") {
+            options.vsync = true;
+        } else if (arg == "--fps" && i + 1 < argc) {
+            options.fpsLimit = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--fullscreen") {
+            options.fullscreen = true;
+        } else if (arg == "--render-scale" && i + 1 < argc) {
+            options.renderScale = std::clamp(std::atoi(argv[++i]), 50, 200);
+        }
+    }
+    
+    if (options.packAssets) {
+        return packAssets();
+    }
+    
+    if (options.batchGames > 0) {
+        return runBatchReport(options);
+    }
+    
+    if (options.headless) {
+        if (!options.replayPath.empty()) {
+            return verifyReplays(options.replayPath);
+        }
+        return runHeadless(options);
+    }
+    
+    RussiaRunner game(options);
     game.run();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+
+// Вид на логическое поле logicalSize: поле целиком помещается в окно с
+// сохранением пропорций и стоит по центру, лишние края окна остаются полосами.
+// Все, что рисуется в окно с этим видом, задается в логических координатах.
+inline sf::View letterboxView(sf::Vector2f logicalSize, sf::Vector2u windowSize) {
+    sf::View view(sf::FloatRect({0.0f, 0.0f}, logicalSize));
+    if (windowSize.x == 0 || windowSize.y == 0) {
+        return view;
+    }
+    float windowAspect = static_cast<float>(windowSize.x) / windowSize.y;
+    float fieldAspect = logicalSize.x / logicalSize.y;
+    sf::FloatRect viewport({0.0f, 0.0f}, {1.0f, 1.0f});
+    if (windowAspect > fieldAspect) {
+        viewport.size.x = fieldAspect / windowAspect;
+        viewport.position.x = (1.0f - viewport.size.x) / 2.0f;
+    } else {
+        viewport.size.y = windowAspect / fieldAspect;
+        viewport.position.y = (1.0f - viewport.size.y) / 2.0f;
+    }
+    view.setViewport(viewport);
+    return view;
+}
+
+// Холст игрового поля с внутренним масштабом отрисовки. Поле рисуется в
+// RenderTexture размером (пиксели поля в окне) x scale и растягивается в окно
+// одним спрайтом: на 50% закрашивается в 4 раза меньше пикселей, на 200%
+// картинка сглаживается уменьшением. На 100% текстура не нужна - поле рисуется
+// прямо в окно; так же, если текстуру создать не удалось.
+class ScaledCanvas {
+public:
+    static constexpr float MIN_SCALE = 0.5f;
+    static constexpr float MAX_SCALE = 2.0f;
+
+private:
+    sf::RenderTexture texture;
+    bool hasTexture = false;
+    sf::Vector2f logicalSize;
+    sf::Vector2u pixelSize;
+    float scale = 1.0f;
+    
+    static unsigned scaledSide(unsigned pixels, float factor) {
+        long side = std::lround(pixels * factor);
+        return static_cast<unsigned>(std::clamp<long>(side, 1, sf::Texture::getMaximumSize()));
+    }
+
+public:
+    // logical - размер поля, pixels - сколько пикселей оно занимает в окне
+    bool resize(sf::Vector2f logical, sf::Vector2u pixels, float renderScale) {
+        logicalSize = logical;
+        scale = std::clamp(renderScale, MIN_SCALE, MAX_SCALE);
+        pixelSize = {scaledSide(pixels.x, scale), scaledSide(pixels.y, scale)};
+        hasTexture = false;
+        if (scale == 1.0f) {
+            return true;
+        }
+        if (!texture.resize(pixelSize)) {
+            return false;
+        }
+        texture.setSmooth(true);
+        texture.setView(sf::View(sf::FloatRect({0.0f, 0.0f}, logicalSize)));
+        hasTexture = true;
+        return true;
+    }
+    
+    // Куда рисовать поле в этом кадре; текстура очищается цветом background
+    sf::RenderTarget& begin(sf::RenderTarget& window, sf::Color background) {
+        if (!hasTexture) {
+            return window;
+        }
+        texture.clear(background);
+        return texture;
+    }
+    
+    // Вывод нарисованного поля в окно (вид окна - логический)
+    void present(sf::RenderTarget& window) {
+        if (!hasTexture) {
+            return;
+        }
+        texture.display();
+        sf::Sprite sprite(texture.getTexture());
+        sprite.setScale({logicalSize.x / pixelSize.x, logicalSize.y / pixelSize.y});
+        window.draw(sprite);
+    }
+    
+    sf::Vector2u getPixelSize() const { return pixelSize; }
+    float getScale() const { return scale; }
+};
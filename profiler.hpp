@@ -0,0 +1,201 @@
+#pragma once
+
+// Профилировщик зон. Собирается только с -DRR_PROFILE (compile.bat profile);
+// в обычной сборке макросы ниже раскрываются в пустоту и кода профилировщика нет.
+//
+//   RR_PROFILE_ZONE("name") - замер до конца текущего блока
+//   RR_PROFILE_ZONE_IF(switch, "name") - то же, если включен ProfileSwitch объекта
+//   RR_PROFILE_FRAME()      - граница кадра (для графика времени кадра)
+
+#ifdef RR_PROFILE
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <algorithm>
+#include <functional>
+
+class Profiler {
+public:
+    // Событие для трассы: имя - строковый литерал, время в наносекундах
+    struct Event {
+        const char* name;
+        std::uint64_t start;
+        std::uint64_t duration;
+        std::uint32_t thread;
+    };
+    
+    // Последние замеры зоны для перцентилей
+    struct Zone {
+        const char* name = nullptr;
+        float samples[256] = {};
+        int next = 0;
+        int count = 0;
+    };
+    
+    static const std::size_t EVENT_CAPACITY = 1 << 18;
+    static const int MAX_ZONES = 32;
+    static const int FRAME_HISTORY = 240;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    Clock::time_point origin = Clock::now();
+    std::vector<Event> events = std::vector<Event>(EVENT_CAPACITY);
+    std::size_t eventCount = 0;
+    Zone zones[MAX_ZONES];
+    int zoneCount = 0;
+    float frameTimes[FRAME_HISTORY] = {};
+    int frameNext = 0;
+    std::uint64_t lastFrame = 0;
+    mutable std::mutex mutex;
+    
+    static std::uint32_t threadNumber() {
+        return static_cast<std::uint32_t>(std::hash<std::thread::id>()(std::this_thread::get_id()) & 0xFFFF);
+    }
+    
+    Zone& zoneFor(const char* name) {
+        for (int i = 0; i < zoneCount; ++i) {
+            if (zones[i].name == name || std::strcmp(zones[i].name, name) == 0) {
+                return zones[i];
+            }
+        }
+        if (zoneCount == MAX_ZONES) {
+            return zones[MAX_ZONES - 1];
+        }
+        zones[zoneCount].name = name;
+        return zones[zoneCount++];
+    }
+
+public:
+    static Profiler& instance() {
+        static Profiler profiler;
+        return profiler;
+    }
+    
+    std::uint64_t now() const {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - origin).count());
+    }
+    
+    void record(const char* name, std::uint64_t start, std::uint64_t end) {
+        std::lock_guard<std::mutex> lock(mutex);
+        events[eventCount % EVENT_CAPACITY] = {name, start, end - start, threadNumber()};
+        eventCount++;
+        
+        Zone& zone = zoneFor(name);
+        zone.samples[zone.next] = static_cast<float>((end - start) / 1e6);
+        zone.next = (zone.next + 1) % 256;
+        zone.count = std::min(zone.count + 1, 256);
+    }
+    
+    void frame() {
+        std::uint64_t time = now();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (lastFrame != 0) {
+            frameTimes[frameNext] = static_cast<float>((time - lastFrame) / 1e6);
+            frameNext = (frameNext + 1) % FRAME_HISTORY;
+        }
+        lastFrame = time;
+    }
+    
+    // Время последних кадров в мс, от старого к новому
+    void copyFrameTimes(float* out) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < FRAME_HISTORY; ++i) {
+            out[i] = frameTimes[(frameNext + i) % FRAME_HISTORY];
+        }
+    }
+    
+    // Перцентили по зонам: вызывает visit(name, p50, p99) в мс
+    template <typename Visitor>
+    void forEachZone(Visitor visit) const {
+        std::lock_guard<std::mutex> lock(mutex);
+        float sorted[256];
+        for (int i = 0; i < zoneCount; ++i) {
+            const Zone& zone = zones[i];
+            if (zone.count == 0) {
+                continue;
+            }
+            std::copy(zone.samples, zone.samples + zone.count, sorted);
+            std::sort(sorted, sorted + zone.count);
+            visit(zone.name, sorted[zone.count / 2], sorted[(zone.count * 99) / 100]);
+        }
+    }
+    
+    // Запись последних seconds секунд в формате Chrome trace_event (chrome://tracing)
+    bool dumpTrace(const std::string& path, double seconds) const {
+        std::FILE* file = std::fopen(path.c_str(), "w");
+        if (!file) {
+            return false;
+        }
+        
+        std::lock_guard<std::mutex> lock(mutex);
+        std::uint64_t end = now();
+        std::uint64_t window = static_cast<std::uint64_t>(seconds * 1e9);
+        std::uint64_t from = end > window ? end - window : 0;
+        std::size_t stored = std::min(eventCount, EVENT_CAPACITY);
+        
+        std::fputs("{\"traceEvents\":[\n", file);
+        bool first = true;
+        for (std::size_t i = eventCount - stored; i < eventCount; ++i) {
+            const Event& event = events[i % EVENT_CAPACITY];
+            if (event.start < from) {
+                continue;
+            }
+            std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                         first ? "" : ",\n", event.name, event.thread, event.start / 1e3, event.duration / 1e3);
+            first = false;
+        }
+        std::fputs("\n],\"displayTimeUnit\":\"ms\"}\n", file);
+        return std::fclose(file) == 0;
+    }
+};
+
+// Замер блока: время записывается в деструкторе; выключенная зона ничего не пишет
+class ProfileZone {
+private:
+    const char* name;
+    std::uint64_t start;
+
+public:
+    explicit ProfileZone(const char* zoneName, bool enabled = true)
+        : name(enabled ? zoneName : nullptr), start(enabled ? Profiler::instance().now() : 0) {}
+    
+    ~ProfileZone() {
+        if (name) {
+            Profiler::instance().record(name, start, Profiler::instance().now());
+        }
+    }
+    
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#define RR_PROFILE_CONCAT_IMPL(a, b) a##b
+#define RR_PROFILE_CONCAT(a, b) RR_PROFILE_CONCAT_IMPL(a, b)
+// Замеры одного объекта, а не всех его копий: флаг при копировании не переносится.
+// Так зоны GameWorld пишет только живой мир, а не сотни копий автопилота за тик.
+struct ProfileSwitch {
+    bool enabled = false;
+    
+    ProfileSwitch() = default;
+    ProfileSwitch(const ProfileSwitch&) {}
+    ProfileSwitch& operator=(const ProfileSwitch&) { return *this; }
+};
+
+#define RR_PROFILE_ZONE(name) ProfileZone RR_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define RR_PROFILE_ZONE_IF(profileSwitch, name) ProfileZone RR_PROFILE_CONCAT(profileZone, __LINE__)(name, (profileSwitch).enabled)
+#define RR_PROFILE_FRAME() Profiler::instance().frame()
+
+#else
+
+#define RR_PROFILE_ZONE(name) ((void)0)
+#define RR_PROFILE_ZONE_IF(profileSwitch, name) ((void)0)
+#define RR_PROFILE_FRAME() ((void)0)
+
+#endif
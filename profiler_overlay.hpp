@@ -0,0 +1,85 @@
+#pragma once
+
+#include "profiler.hpp"
+
+#ifdef RR_PROFILE
+
+#include <SFML/Graphics.hpp>
+#include <cstdio>
+#include <string>
+
+// Оверлей профилировщика (F3): график времени кадров и p50/p99 по зонам
+class ProfilerOverlay {
+private:
+    sf::RectangleShape background;
+    sf::VertexArray graph{sf::PrimitiveType::Lines};
+    sf::Text text;
+    sf::Clock refreshClock;
+    std::string lines;
+    
+    // Верх графика соответствует 33 мс (30 кадров в секунду)
+    static constexpr float GRAPH_MS = 33.3f;
+    static constexpr float GRAPH_HEIGHT = 80.0f;
+    static constexpr float LEFT = 350.0f;
+    static constexpr float TOP = 10.0f;
+    
+    void rebuild() {
+        float frames[Profiler::FRAME_HISTORY];
+        Profiler::instance().copyFrameTimes(frames);
+        
+        // Столбики кадров и линии 60 и 120 FPS
+        graph.resize(Profiler::FRAME_HISTORY * 2 + 4);
+        float bottom = TOP + GRAPH_HEIGHT;
+        for (int i = 0; i < Profiler::FRAME_HISTORY; ++i) {
+            float x = LEFT + i;
+            float height = std::min(frames[i] / GRAPH_MS, 1.0f) * GRAPH_HEIGHT;
+            sf::Color color = frames[i] > 16.7f ? sf::Color::Red : (frames[i] > 8.4f ? sf::Color::Yellow : sf::Color::Green);
+            graph[i * 2] = sf::Vertex{{x, bottom}, color};
+            graph[i * 2 + 1] = sf::Vertex{{x, bottom - height}, color};
+        }
+        std::size_t marks = Profiler::FRAME_HISTORY * 2;
+        float y60 = bottom - 16.7f / GRAPH_MS * GRAPH_HEIGHT;
+        float y120 = bottom - 8.3f / GRAPH_MS * GRAPH_HEIGHT;
+        graph[marks] = sf::Vertex{{LEFT, y60}, sf::Color::White};
+        graph[marks + 1] = sf::Vertex{{LEFT + Profiler::FRAME_HISTORY, y60}, sf::Color::White};
+        graph[marks + 2] = sf::Vertex{{LEFT, y120}, sf::Color(128, 128, 128)};
+        graph[marks + 3] = sf::Vertex{{LEFT + Profiler::FRAME_HISTORY, y120}, sf::Color(128, 128, 128)};
+        
+        lines = "zone              p50 ms   p99 ms\n";
+        Profiler::instance().forEachZone([this](const char* name, float p50, float p99) {
+            char line[96];
+            std::snprintf(line, sizeof(line), "%-16.16s %7.3f  %7.3f\n", name, p50, p99);
+            lines += line;
+        });
+        text.setString(lines);
+        
+        float height = GRAPH_HEIGHT + 10.0f + text.getLocalBounds().size.y + 10.0f;
+        background.setSize({Profiler::FRAME_HISTORY + 10.0f, height});
+    }
+
+public:
+    bool visible = false;
+    
+    explicit ProfilerOverlay(const sf::Font& font) : text(font, "", 12) {
+        background.setPosition({LEFT - 5.0f, TOP - 5.0f});
+        background.setFillColor(sf::Color(0, 0, 0, 170));
+        text.setFillColor(sf::Color::White);
+        text.setPosition({LEFT, TOP + GRAPH_HEIGHT + 5.0f});
+    }
+    
+    void draw(sf::RenderTarget& target) {
+        if (!visible) {
+            return;
+        }
+        // Таблица и график обновляются 4 раза в секунду, чтобы их можно было прочитать
+        if (refreshClock.getElapsedTime().asSeconds() >= 0.25f || lines.empty()) {
+            rebuild();
+            refreshClock.restart();
+        }
+        target.draw(background);
+        target.draw(graph);
+        target.draw(text);
+    }
+};
+
+#endif
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include "game_world.hpp"
+
+// Снимок мира после тика: все, что нужно окну для кадра и HUD.
+// Поток симуляции заполняет снимок и отдает его через тройной буфер, поток
+// окна рисует только по снимку и к GameWorld не обращается.
+// Вместе с текущими значениями лежат значения прошлого тика, чтобы кадр можно
+// было нарисовать между двумя тиками (alpha от 0 до 1).
+struct RenderSnapshot {
+    using Clock = std::chrono::steady_clock;
+    
+    // Препятствие или буст: прямоугольник на конец тика и тип
+    struct Body {
+        float x;
+        float y;
+        float w;
+        float h;
+        int type;
+    };
+    
+    // Игрок или спутник
+    struct RunnerView {
+        float x;
+        float baseY;
+        float prevHeight;
+        float height;
+        int frame;
+        
+        float renderY(float alpha) const {
+            return baseY - (prevHeight + (height - prevHeight) * alpha);
+        }
+    };
+    
+    // Когда посчитан тик и сколько длится тик (при ускоренном повторе короче)
+    Clock::time_point time;
+    float tickSeconds = TICK_DT;
+    long long tick = 0;
+    
+    // Забег закончен (проигрыш или конец повтора), это последний снимок
+    bool finished = false;
+    
+    // Дорога и прокрутка
+    float prevRoadOffset = 0.0f;
+    float roadSpeed = 0.0f;
+    float roadTileHeight = 0.0f;
+    float scrollStep = 0.0f;
+    
+    // Игрок
+    RunnerView player{};
+    int playerLane = 1;
+    bool mopedActive = false;
+    int mopedRideFrame = 0;
+    
+    // HUD: счет и бусты, оставшееся время в секундах
+    int score = 0;
+    int mopedCount = 0;
+    bool energyActive = false;
+    bool seedsActive = false;
+    bool macasinActive = false;
+    float energyLeft = 0.0f;
+    float seedsLeft = 0.0f;
+    float macasinLeft = 0.0f;
+    float mopedLeft = 0.0f;
+    
+    std::vector<Body> obstacles;
+    std::vector<Body> boosts;
+    std::vector<RunnerView> followers;
+    
+    // Нагрузочный режим: суммарное время тиков и проверок столкновений
+    double stepSeconds = 0.0;
+    double collisionSeconds = 0.0;
+    
+    // Перемотка: сколько секунд доступно, сколько байт занято, цена захвата тика
+    float rewindSeconds = 0.0f;
+    std::size_t rewindBytes = 0;
+    double rewindCaptureSeconds = 0.0;
+    
+    // Автопилот включен и скорость его поиска
+    bool autopilot = false;
+    double searchStatesPerSecond = 0.0;
+    
+    // Память под сущности выделяется один раз, дальше снимок переиспользуется
+    RenderSnapshot() {
+        obstacles.reserve(GameWorld::MAX_OBSTACLES);
+        boosts.reserve(GameWorld::MAX_BOOSTS);
+        followers.reserve(GameWorld::MAX_FOLLOWERS);
+    }
+    
+    void capture(const GameWorld& world) {
+        time = Clock::now();
+        tick = world.tick;
+        
+        prevRoadOffset = world.prevRoadOffset;
+        roadSpeed = world.roadSpeed;
+        roadTileHeight = world.roadTileHeight;
+        scrollStep = world.lastScrollStep;
+        
+        const Jump& jump = world.player<Jump>();
+        player = {world.playerX(), world.player<Runner>().baseY, jump.prevHeight, jump.height,
+                  world.player<Animation>().frame};
+        playerLane = world.player<Lane>().lane;
+        mopedActive = world.isMopedActive;
+        mopedRideFrame = world.mopedRideFrame;
+        
+        score = world.score;
+        mopedCount = world.mopedCount;
+        energyActive = world.hasEnergyBoost;
+        seedsActive = world.hasSeedsBoost;
+        macasinActive = world.hasMacasinBoost;
+        energyLeft = world.timeLeft(ENERGY_END);
+        seedsLeft = world.timeLeft(SEEDS_END);
+        macasinLeft = world.timeLeft(MACASIN_END);
+        mopedLeft = world.timeLeft(MOPED_END);
+        
+        obstacles.clear();
+        world.entities.each<Position, Extent, Obstacle>(
+            [this](const Position& position, const Extent& extent, const Obstacle& obstacle) {
+                obstacles.push_back({position.x, position.y, extent.w, extent.h, obstacle.type});
+            });
+        boosts.clear();
+        world.entities.each<Position, Extent, Boost>(
+            [this](const Position& position, const Extent& extent, const Boost& boost) {
+                boosts.push_back({position.x, position.y, extent.w, extent.h, boost.type});
+            });
+        followers.clear();
+        world.entities.each<Runner, Lane, Jump, Animation, Follow>(
+            [this, &world](const Runner& runner, const Lane& lane, const Jump& follower, const Animation& animation, const Follow&) {
+                followers.push_back({world.runnerX(lane), runner.baseY, follower.prevHeight, follower.height, animation.frame});
+            });
+        
+        collisionSeconds = world.collisionSeconds;
+    }
+    
+    // Доля тика, прошедшая с момента снимка
+    float alphaAt(Clock::time_point now) const {
+        float alpha = std::chrono::duration<float>(now - time).count() / tickSeconds;
+        return alpha < 0.0f ? 0.0f : (alpha > 1.0f ? 1.0f : alpha);
+    }
+    
+    float renderScrollShift(float alpha) const {
+        return -scrollStep * (1.0f - alpha);
+    }
+    
+    float renderRoadOffset(float alpha) const {
+        float offset = prevRoadOffset + roadSpeed * TICK_DT * alpha;
+        if (roadTileHeight > 0.0f && offset >= roadTileHeight) {
+            offset -= roadTileHeight;
+        }
+        return offset;
+    }
+};
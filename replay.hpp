@@ -0,0 +1,316 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include "game_world.hpp"
+#include "mapped_file.hpp"
+
+// Формат файла повтора (.rpl):
+//   "RRPL", версия (1 байт), seed (varint)
+//   с версии 3: хитбоксы игрока и мопеда - ширина и высота (4 float, LE)
+//   команды: varint((разница тиков с прошлой командой << 2) | команда)
+//   хвост: конечный тик (varint), счет (varint), смерть (1 байт),
+//          хэш состояния (8 байт LE), длина хвоста без этого байта (1 байт)
+// Версии: 1 - препятствия по таймеру и отсчеты бустов в секундах float
+// (GameWorld::legacyTiming), 2 - препятствия из генератора трассы,
+// 3 - то же, что 2, плюс хитбоксы в заголовке. Версия говорит, как проигрывать
+// забег; файлы до третьей версии идут с хитбоксами GameWorld по умолчанию (50x50).
+
+const unsigned char REPLAY_VERSION = 3;
+const std::size_t REPLAY_HEADER_SIZE = 5;
+
+inline void writeVarint(std::vector<unsigned char>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<unsigned char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<unsigned char>(value));
+}
+
+inline bool readVarint(const unsigned char*& cursor, const unsigned char* end, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && cursor < end; shift += 7) {
+        unsigned char byte = *cursor++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// float побитово, младший байт первым
+inline void writeFloat(std::vector<unsigned char>& out, float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<unsigned char>(bits >> (i * 8)));
+    }
+}
+
+inline bool readFloat(const unsigned char*& cursor, const unsigned char* end, float& value) {
+    if (end - cursor < 4) {
+        return false;
+    }
+    std::uint32_t bits = 0;
+    for (int i = 0; i < 4; ++i) {
+        bits |= static_cast<std::uint32_t>(*cursor++) << (i * 8);
+    }
+    std::memcpy(&value, &bits, sizeof(value));
+    return true;
+}
+
+// Итог забега, записанный в хвосте файла
+struct ReplaySummary {
+    int version = REPLAY_VERSION;
+    std::uint64_t seed = 0;
+    long long endTick = 0;
+    int score = 0;
+    bool died = false;
+    std::uint64_t stateHash = 0;
+    
+    // Хитбоксы, с которыми шел забег (в игре - по размеру спрайтов); в заголовке
+    // с версии 3, для старых файлов - значения по умолчанию
+    float playerWidth = 50.0f;
+    float playerHeight = 50.0f;
+    float mopedWidth = 50.0f;
+    float mopedHeight = 50.0f;
+    
+    // Настройка мира, без которой забег не повторится
+    void configure(GameWorld& world) const {
+        world.generatedTrack = version >= 2;
+        world.legacyTiming = version < 2;
+        world.playerWidth = playerWidth;
+        world.playerHeight = playerHeight;
+        world.mopedWidth = mopedWidth;
+        world.mopedHeight = mopedHeight;
+    }
+};
+
+// Запись seed и команд забега
+class ReplayRecorder {
+private:
+    std::vector<unsigned char> bytes;
+    long long lastTick = 0;
+    bool recording = false;
+    
+    // Где в bytes начинается каждая команда и на каком она тике (для перемотки)
+    std::vector<std::size_t> commandStarts;
+    std::vector<long long> commandTicks;
+
+public:
+    // Начало записи забега, только что сброшенного world.reset
+    void begin(const GameWorld& world) {
+        bytes.clear();
+        bytes.insert(bytes.end(), {'R', 'R', 'P', 'L', REPLAY_VERSION});
+        writeVarint(bytes, world.seed);
+        writeFloat(bytes, world.playerWidth);
+        writeFloat(bytes, world.playerHeight);
+        writeFloat(bytes, world.mopedWidth);
+        writeFloat(bytes, world.mopedHeight);
+        lastTick = 0;
+        recording = true;
+        commandStarts.clear();
+        commandTicks.clear();
+    }
+    
+    void record(long long tick, Command command) {
+        if (!recording) {
+            return;
+        }
+        commandStarts.push_back(bytes.size());
+        commandTicks.push_back(tick);
+        std::uint64_t delta = static_cast<std::uint64_t>(tick - lastTick);
+        writeVarint(bytes, (delta << 2) | static_cast<std::uint64_t>(command));
+        lastTick = tick;
+    }
+    
+    // Мир отмотан к состоянию после tick тиков: команды с тика tick и позже
+    // не случились и из записи убираются
+    void rewind(long long tick) {
+        if (!recording) {
+            return;
+        }
+        std::size_t kept = commandTicks.size();
+        while (kept > 0 && commandTicks[kept - 1] >= tick) {
+            kept--;
+        }
+        if (kept == commandTicks.size()) {
+            return;
+        }
+        bytes.resize(commandStarts[kept]);
+        commandStarts.resize(kept);
+        commandTicks.resize(kept);
+        lastTick = kept > 0 ? commandTicks[kept - 1] : 0;
+    }
+    
+    // Завершение записи итоговым состоянием мира
+    void finish(const GameWorld& world) {
+        if (!recording) {
+            return;
+        }
+        std::size_t trailerStart = bytes.size();
+        writeVarint(bytes, static_cast<std::uint64_t>(world.tick));
+        writeVarint(bytes, static_cast<std::uint64_t>(world.score));
+        bytes.push_back(world.gameOver ? 1 : 0);
+        std::uint64_t hash = world.stateHash();
+        for (int i = 0; i < 8; ++i) {
+            bytes.push_back(static_cast<unsigned char>(hash >> (i * 8)));
+        }
+        bytes.push_back(static_cast<unsigned char>(bytes.size() - trailerStart));
+        recording = false;
+    }
+    
+    bool isRecording() const { return recording; }
+    const std::vector<unsigned char>& data() const { return bytes; }
+    
+    bool save(const std::string& path) const {
+        std::ofstream file(path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        return static_cast<bool>(file);
+    }
+};
+
+// Чтение повтора прямо из памяти (обычно из MappedFile), без копирования команд
+class ReplayReader {
+private:
+    const unsigned char* cursor = nullptr;
+    const unsigned char* commandsEnd = nullptr;
+    ReplaySummary summary;
+    long long nextTick = 0;
+    Command nextCommand = Command::JUMP;
+    bool hasNext = false;
+    
+    void advance() {
+        std::uint64_t value = 0;
+        hasNext = cursor < commandsEnd && readVarint(cursor, commandsEnd, value);
+        if (hasNext) {
+            nextTick += static_cast<long long>(value >> 2);
+            nextCommand = static_cast<Command>(value & 3);
+        }
+    }
+
+public:
+    bool open(const unsigned char* data, std::size_t size) {
+        if (!data || size < REPLAY_HEADER_SIZE + 2 ||
+            data[0] != 'R' || data[1] != 'R' || data[2] != 'P' || data[3] != 'L' ||
+            data[4] < 1 || data[4] > REPLAY_VERSION) {
+            return false;
+        }
+        // Итог прошлого файла (в том числе его хитбоксы) не должен перейти в этот
+        summary = ReplaySummary();
+        summary.version = data[4];
+        
+        const unsigned char* end = data + size;
+        cursor = data + REPLAY_HEADER_SIZE;
+        if (!readVarint(cursor, end, summary.seed)) {
+            return false;
+        }
+        if (summary.version >= 3 &&
+            (!readFloat(cursor, end, summary.playerWidth) || !readFloat(cursor, end, summary.playerHeight) ||
+             !readFloat(cursor, end, summary.mopedWidth) || !readFloat(cursor, end, summary.mopedHeight))) {
+            return false;
+        }
+        
+        // Хвост читается с конца файла
+        std::size_t trailerSize = data[size - 1];
+        if (trailerSize < 11 || trailerSize + 1 > static_cast<std::size_t>(end - cursor)) {
+            return false;
+        }
+        commandsEnd = end - 1 - trailerSize;
+        
+        const unsigned char* trailer = commandsEnd;
+        std::uint64_t endTick = 0;
+        std::uint64_t score = 0;
+        if (!readVarint(trailer, end - 1, endTick) || !readVarint(trailer, end - 1, score) ||
+            end - 1 - trailer != 9) {
+            return false;
+        }
+        summary.endTick = static_cast<long long>(endTick);
+        summary.score = static_cast<int>(score);
+        summary.died = *trailer++ != 0;
+        summary.stateHash = 0;
+        for (int i = 0; i < 8; ++i) {
+            summary.stateHash |= static_cast<std::uint64_t>(trailer[i]) << (i * 8);
+        }
+        
+        nextTick = 0;
+        advance();
+        return true;
+    }
+    
+    const ReplaySummary& getSummary() const { return summary; }
+    
+    // Подача команд, отмеченных текущим тиком мира
+    void feed(GameWorld& world) {
+        while (hasNext && nextTick == world.tick) {
+            world.applyCommand(nextCommand);
+            advance();
+        }
+    }
+    
+    bool finished(const GameWorld& world) const {
+        return world.gameOver || world.tick >= summary.endTick;
+    }
+};
+
+// Результат проверки повтора текущей сборкой
+struct ReplayCheck {
+    bool valid = false;
+    bool matches = false;
+    ReplaySummary expected;
+    ReplaySummary actual;
+};
+
+// Прогон повтора без окна с максимальной скоростью
+inline ReplayCheck verifyReplay(const unsigned char* data, std::size_t size, GameWorld& world) {
+    ReplayCheck check;
+    ReplayReader reader;
+    if (!reader.open(data, size)) {
+        return check;
+    }
+    check.valid = true;
+    check.expected = reader.getSummary();
+    
+    // Файлы первой версии писали и сборки с колесом таймеров (до генератора
+    // трассы), по заголовку их не отличить: если отсчеты в секундах не сошлись,
+    // забег проигрывается еще раз по колесу
+    check.expected.configure(world);
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (attempt > 0) {
+            if (check.expected.version >= 2) {
+                break;
+            }
+            reader.open(data, size);
+            world.legacyTiming = false;
+        }
+        world.reset(check.expected.seed);
+        for (;;) {
+            reader.feed(world);
+            if (reader.finished(world)) {
+                break;
+            }
+            world.step();
+        }
+        
+        check.actual.seed = world.seed;
+        check.actual.endTick = world.tick;
+        check.actual.score = world.score;
+        check.actual.died = world.gameOver;
+        check.actual.stateHash = world.stateHash();
+        check.matches = check.actual.endTick == check.expected.endTick &&
+                        check.actual.score == check.expected.score &&
+                        check.actual.died == check.expected.died &&
+                        check.actual.stateHash == check.expected.stateHash;
+        if (check.matches) {
+            break;
+        }
+    }
+    return check;
+}
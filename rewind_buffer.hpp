@@ -0,0 +1,352 @@
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include "game_world.hpp"
+#include "replay.hpp"
+
+// Запись состояния мира в байты (см. GameWorld::transferState)
+class StateWriter {
+private:
+    std::vector<unsigned char>& bytes;
+
+public:
+    explicit StateWriter(std::vector<unsigned char>& out) : bytes(out) {}
+    
+    template <typename T>
+    void value(const T& item) {
+        array(&item, 1);
+    }
+    
+    template <typename T>
+    void array(const T* items, std::size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "state is stored as raw bytes");
+        const unsigned char* begin = reinterpret_cast<const unsigned char*>(items);
+        bytes.insert(bytes.end(), begin, begin + count * sizeof(T));
+    }
+};
+
+// Чтение состояния мира из байтов, записанных StateWriter
+class StateReader {
+private:
+    const unsigned char* cursor;
+    const unsigned char* end;
+    bool ok = true;
+
+public:
+    StateReader(const unsigned char* data, std::size_t size) : cursor(data), end(data + size) {}
+    
+    template <typename T>
+    void value(T& item) {
+        array(&item, 1);
+    }
+    
+    template <typename T>
+    void array(T* items, std::size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value, "state is stored as raw bytes");
+        std::size_t size = count * sizeof(T);
+        if (!ok || static_cast<std::size_t>(end - cursor) < size) {
+            ok = false;
+            return;
+        }
+        std::memcpy(static_cast<void*>(items), cursor, size);
+        cursor += size;
+    }
+    
+    // Прочитано ровно все
+    bool valid() const { return ok && cursor == end; }
+};
+
+// Разность двух образов состояния: XOR с base (байты за концом base считаются
+// нулями), записанный парами "сколько нулей пропустить, сколько байтов дальше".
+// Соседние тики отличаются немногими байтами, так что разность в разы меньше
+// образа; с пустым base получается просто сжатие нулей для опорного кадра.
+const std::size_t XOR_DELTA_MIN_ZEROS = 4; // Более короткие нули остаются внутри литерала
+
+inline void encodeXorDelta(const std::vector<unsigned char>& image, const std::vector<unsigned char>& base,
+                           std::vector<unsigned char>& out) {
+    const std::size_t size = image.size();
+    const std::size_t common = std::min(size, base.size());
+    auto diff = [&](std::size_t i) -> unsigned char {
+        return i < common ? image[i] ^ base[i] : image[i];
+    };
+    
+    out.clear();
+    writeVarint(out, size);
+    std::size_t i = 0;
+    while (i < size) {
+        // Одинаковые байты пропускаются по 8 за раз
+        std::size_t start = i;
+        while (start + 8 <= common && std::memcmp(&image[start], &base[start], 8) == 0) {
+            start += 8;
+        }
+        while (start < size && diff(start) == 0) {
+            start++;
+        }
+        if (start == size) {
+            break;
+        }
+        std::size_t stop = start;
+        for (std::size_t j = start; j < size && j - stop < XOR_DELTA_MIN_ZEROS; ++j) {
+            if (diff(j) != 0) {
+                stop = j + 1;
+            }
+        }
+        writeVarint(out, start - i);
+        writeVarint(out, stop - start);
+        for (std::size_t j = start; j < stop; ++j) {
+            out.push_back(diff(j));
+        }
+        i = stop;
+    }
+}
+
+// image - образ, от которого считалась разность; на выходе - новый образ
+inline bool applyXorDelta(const unsigned char* data, std::size_t size, std::vector<unsigned char>& image) {
+    const unsigned char* cursor = data;
+    const unsigned char* end = data + size;
+    std::uint64_t imageSize;
+    if (!readVarint(cursor, end, imageSize)) {
+        return false;
+    }
+    image.resize(static_cast<std::size_t>(imageSize));
+    std::size_t position = 0;
+    while (cursor < end) {
+        std::uint64_t zeros;
+        std::uint64_t literal;
+        if (!readVarint(cursor, end, zeros) || !readVarint(cursor, end, literal)) {
+            return false;
+        }
+        position += static_cast<std::size_t>(zeros);
+        if (position + literal > image.size() || literal > static_cast<std::uint64_t>(end - cursor)) {
+            return false;
+        }
+        for (std::uint64_t k = 0; k < literal; ++k) {
+            image[position++] ^= *cursor++;
+        }
+    }
+    return true;
+}
+
+// Перемотка: состояние мира на каждом тике за последние секунды.
+// Раз в KEYFRAME_TICKS тиков пишется опорный кадр (весь образ, сжаты только
+// нули), между ними - разность с предыдущим тиком. Кадры лежат в кольце
+// байтов фиксированного размера, самые старые вытесняются целыми группами
+// "опорный кадр + его разности", так что память ограничена и числом кадров,
+// и числом байтов. Восстановление тика - опорный кадр и не больше
+// KEYFRAME_TICKS - 1 разностей после него, после чего игра продолжается ровно так,
+// как продолжилась бы с этого тика.
+class RewindBuffer {
+public:
+    static const int KEYFRAME_TICKS = TICK_RATE / 2;
+
+private:
+    struct Frame {
+        long long tick = 0;
+        std::size_t offset = 0;
+        std::size_t size = 0;
+        bool key = false;
+    };
+    
+    std::vector<unsigned char> storage;
+    std::size_t head = 0; // Куда пойдет следующий кадр
+    std::size_t storedBytes = 0;
+    
+    std::vector<Frame> frames; // Кольцо кадров от старого к новому
+    std::size_t first = 0;
+    std::size_t count = 0;
+    long long lastKeyTick = 0;
+    
+    // Рабочие буферы, чтобы захват не выделял память
+    std::vector<unsigned char> image;
+    std::vector<unsigned char> previous; // Образ последнего кадра
+    std::vector<unsigned char> encoded;
+    std::vector<unsigned char> noBase; // Всегда пустой: база опорного кадра
+    
+    double captureSeconds = 0.0;
+    long long captures = 0;
+    
+    Frame& at(std::size_t index) {
+        return frames[(first + index) % frames.size()];
+    }
+    
+    const Frame& at(std::size_t index) const {
+        return frames[(first + index) % frames.size()];
+    }
+    
+    void dropOldest() {
+        storedBytes -= at(0).size;
+        first = (first + 1) % frames.size();
+        count--;
+    }
+    
+    // Самый старый опорный кадр уходит вместе со всеми разностями после него
+    void evictGroup() {
+        dropOldest();
+        while (count > 0 && !at(0).key) {
+            dropOldest();
+        }
+    }
+    
+    // Место под кадр в кольце байтов: после последнего кадра или с начала,
+    // если в конце не хватает; false - сначала нужно что-то вытеснить
+    bool allocate(std::size_t size, std::size_t& offset) const {
+        if (count == 0) {
+            offset = 0;
+            return size <= storage.size();
+        }
+        std::size_t tail = at(0).offset;
+        if (head > tail) {
+            if (storage.size() - head >= size) {
+                offset = head;
+                return true;
+            }
+            if (size < tail) {
+                offset = 0;
+                return true;
+            }
+            return false;
+        }
+        if (tail - head > size) {
+            offset = head;
+            return true;
+        }
+        return false;
+    }
+
+public:
+    // maxFrames - сколько тиков назад можно отмотать, maxBytes - потолок памяти
+    void configure(std::size_t maxFrames, std::size_t maxBytes) {
+        frames.assign(std::max<std::size_t>(maxFrames, 1), Frame());
+        storage.assign(maxBytes, 0);
+        clear();
+    }
+    
+    void clear() {
+        first = 0;
+        count = 0;
+        head = 0;
+        storedBytes = 0;
+        previous.clear();
+    }
+    
+    // Сохранение состояния после тика; тики идут подряд (после restore - с восстановленного)
+    void capture(const GameWorld& world) {
+        if (frames.empty()) {
+            return;
+        }
+        auto start = std::chrono::steady_clock::now();
+        
+        image.clear();
+        StateWriter writer(image);
+        GameWorld::transferState(world, writer);
+        
+        // Новый забег (или тик раньше последнего кадра): старые кадры не нужны
+        if (count > 0 && world.tick <= newestTick()) {
+            clear();
+        }
+        
+        bool key = count == 0 || world.tick - lastKeyTick >= KEYFRAME_TICKS;
+        encodeXorDelta(image, key ? noBase : previous, encoded);
+        if (count == frames.size()) {
+            evictGroup();
+        }
+        std::size_t offset;
+        for (;;) {
+            // Вытеснена и текущая группа: разности не от чего считать
+            if (count == 0 && !key) {
+                key = true;
+                encodeXorDelta(image, noBase, encoded);
+            }
+            if (allocate(encoded.size(), offset)) {
+                break;
+            }
+            if (count == 0) {
+                return; // Кадр больше всего кольца
+            }
+            evictGroup();
+        }
+        
+        std::memcpy(&storage[offset], encoded.data(), encoded.size());
+        Frame& frame = at(count);
+        frame.tick = world.tick;
+        frame.offset = offset;
+        frame.size = encoded.size();
+        frame.key = key;
+        count++;
+        head = offset + encoded.size();
+        storedBytes += encoded.size();
+        if (key) {
+            lastKeyTick = world.tick;
+        }
+        previous.swap(image);
+        
+        captureSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        captures++;
+    }
+    
+    // Возврат мира к состоянию после тика tick (не раньше oldestTick).
+    // Более новые кадры отбрасываются: игра продолжается с этого тика.
+    bool restore(long long tick, GameWorld& world) {
+        if (count == 0 || tick < oldestTick() || tick > newestTick()) {
+            return false;
+        }
+        // Тики в кольце идут подряд, но поиск не полагается на это
+        std::size_t low = 0;
+        std::size_t high = count - 1;
+        while (low < high) {
+            std::size_t middle = (low + high) / 2;
+            if (at(middle).tick < tick) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        std::size_t target = low;
+        std::size_t key = target;
+        while (!at(key).key) {
+            key--;
+        }
+        
+        image.clear();
+        for (std::size_t i = key; i <= target; ++i) {
+            const Frame& frame = at(i);
+            if (!applyXorDelta(&storage[frame.offset], frame.size, image)) {
+                return false;
+            }
+        }
+        StateReader reader(image.data(), image.size());
+        GameWorld::transferState(world, reader);
+        if (!reader.valid()) {
+            return false;
+        }
+        
+        while (count > target + 1) {
+            count--;
+            storedBytes -= at(count).size;
+        }
+        head = at(target).offset + at(target).size;
+        lastKeyTick = at(key).tick;
+        previous.swap(image);
+        return true;
+    }
+    
+    bool empty() const { return count == 0; }
+    long long oldestTick() const { return count > 0 ? at(0).tick : 0; }
+    long long newestTick() const { return count > 0 ? at(count - 1).tick : 0; }
+    std::size_t frameCount() const { return count; }
+    std::size_t bytesUsed() const { return storedBytes; }
+    std::size_t capacityBytes() const { return storage.size(); }
+    
+    // Насколько далеко можно отмотать сейчас, в секундах
+    float coveredSeconds() const {
+        return static_cast<float>(newestTick() - oldestTick()) * TICK_DT;
+    }
+    
+    double averageCaptureSeconds() const {
+        return captures > 0 ? captureSeconds / captures : 0.0;
+    }
+};
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+// Дорога: повторяющаяся текстура и по прямоугольнику на полосу в одном массиве вершин.
+// Геометрия строится один раз, прокрутка меняет только текстурные координаты,
+// поэтому вся дорога рисуется одним вызовом draw при любом числе полос.
+class RoadRenderer {
+private:
+    sf::Texture texture;
+    bool textured = false;
+    sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+    int laneCount = 0;
+    float viewHeight = 0.0f;
+    
+    // Масштаб тайла дороги на экране, как у прежних спрайтов
+    static constexpr float SCALE_Y = 0.25f;
+
+public:
+    // Картинка уже декодирована загрузчиком, здесь только загрузка в видеопамять
+    bool loadFromImage(const sf::Image& image) {
+        textured = texture.loadFromImage(image);
+        if (textured) {
+            texture.setRepeated(true);
+        }
+        return textured;
+    }
+    
+    bool isTextured() const { return textured; }
+    
+    // Высота одного тайла на экране (период прокрутки)
+    float getTileHeight() const {
+        return textured ? texture.getSize().y * SCALE_Y : 0.0f;
+    }
+    
+    // Построение прямоугольников полос
+    void build(const float* lanePositions, int lanes, float laneWidth, float height) {
+        laneCount = lanes;
+        viewHeight = height;
+        vertices.resize(static_cast<std::size_t>(lanes) * 6);
+        
+        float textureWidth = textured ? static_cast<float>(texture.getSize().x) : 0.0f;
+        for (int i = 0; i < lanes; ++i) {
+            float left = lanePositions[i] + 1.0f;
+            float right = left + laneWidth - 2.0f;
+            sf::Vertex* quad = &vertices[static_cast<std::size_t>(i) * 6];
+            quad[0].position = {left, 0.0f};
+            quad[1].position = {right, 0.0f};
+            quad[2].position = {left, height};
+            quad[3].position = {left, height};
+            quad[4].position = {right, 0.0f};
+            quad[5].position = {right, height};
+            
+            quad[0].texCoords.x = quad[2].texCoords.x = quad[3].texCoords.x = 0.0f;
+            quad[1].texCoords.x = quad[4].texCoords.x = quad[5].texCoords.x = textureWidth;
+        }
+        setOffset(0.0f);
+    }
+    
+    // Прокрутка: сдвиг текстуры вниз на offset пикселей экрана
+    void setOffset(float offset) {
+        float top = -offset / SCALE_Y;
+        float bottom = (viewHeight - offset) / SCALE_Y;
+        for (int i = 0; i < laneCount; ++i) {
+            sf::Vertex* quad = &vertices[static_cast<std::size_t>(i) * 6];
+            quad[0].texCoords.y = quad[1].texCoords.y = quad[4].texCoords.y = top;
+            quad[2].texCoords.y = quad[3].texCoords.y = quad[5].texCoords.y = bottom;
+        }
+    }
+    
+    // Без текстуры полосы заливаются цветом, текущая светлее
+    void setHighlightedLane(int lane) {
+        if (textured) {
+            return;
+        }
+        for (int i = 0; i < laneCount; ++i) {
+            sf::Color color = i == lane ? sf::Color(150, 150, 150) : sf::Color(120, 120, 120);
+            for (int v = 0; v < 6; ++v) {
+                vertices[static_cast<std::size_t>(i) * 6 + v].color = color;
+            }
+        }
+    }
+    
+    void draw(sf::RenderTarget& target) const {
+        sf::RenderStates states;
+        states.texture = textured ? &texture : nullptr;
+        target.draw(vertices, states);
+    }
+};
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+// Фиксированный шаг симуляции
+const int TICK_RATE = 120;
+const float TICK_DT = 1.0f / TICK_RATE;
+
+// Генератор случайных чисел забега (xorshift64*): один seed - один и тот же забег
+struct Rng {
+    std::uint64_t state = 0x9E3779B97F4A7C15ull;
+    
+    void seed(std::uint64_t value) {
+        // splitmix64, чтобы близкие seed давали разные последовательности
+        std::uint64_t z = value + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z = z ^ (z >> 31);
+        state = z ? z : 0x9E3779B97F4A7C15ull;
+    }
+    
+    std::uint32_t next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return static_cast<std::uint32_t>((state * 0x2545F4914F6CDD1Dull) >> 32);
+    }
+    
+    // Число в диапазоне [0, n)
+    int nextInt(int n) {
+        return static_cast<int>((static_cast<std::uint64_t>(next()) * static_cast<std::uint64_t>(n)) >> 32);
+    }
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+// Пакетная отрисовка прямоугольников.
+// Каждый слой - постоянный массив вершин с одной текстурой; за кадр он только
+// перезаполняется, а рисуется одним вызовом draw. Цветные прямоугольники берут
+// белый участок той же текстуры, поэтому не разрывают пакет.
+class SpriteBatch {
+private:
+    struct Layer {
+        const sf::Texture* texture = nullptr;
+        sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+        std::size_t used = 0;
+    };
+    
+    std::vector<Layer> layers;
+    sf::FloatRect solidTexCoords;
+    std::size_t drawCalls = 0;
+    std::size_t quadCount = 0;
+    
+    sf::Vertex* allocateQuad(std::size_t layerIndex) {
+        Layer& layer = layers[layerIndex];
+        if (layer.used + 6 > layer.vertices.getVertexCount()) {
+            // Растет только вверх, память переиспользуется между кадрами
+            layer.vertices.resize(std::max<std::size_t>(64, layer.vertices.getVertexCount() * 2));
+        }
+        sf::Vertex* quad = &layer.vertices[layer.used];
+        layer.used += 6;
+        quadCount++;
+        return quad;
+    }
+    
+    static void writeQuad(sf::Vertex* quad, const sf::FloatRect& dest, const sf::FloatRect& tex, sf::Color color) {
+        float left = dest.position.x;
+        float top = dest.position.y;
+        float right = left + dest.size.x;
+        float bottom = top + dest.size.y;
+        float u0 = tex.position.x;
+        float v0 = tex.position.y;
+        float u1 = u0 + tex.size.x;
+        float v1 = v0 + tex.size.y;
+        
+        quad[0] = {{left, top}, color, {u0, v0}};
+        quad[1] = {{right, top}, color, {u1, v0}};
+        quad[2] = {{left, bottom}, color, {u0, v1}};
+        quad[3] = {{left, bottom}, color, {u0, v1}};
+        quad[4] = {{right, top}, color, {u1, v0}};
+        quad[5] = {{right, bottom}, color, {u1, v1}};
+    }
+
+public:
+    explicit SpriteBatch(std::size_t layerCount = 1) : layers(layerCount) {}
+    
+    void setTexture(std::size_t layer, const sf::Texture* texture) {
+        layers[layer].texture = texture;
+    }
+    
+    // Участок текстуры со сплошным белым цветом для цветных прямоугольников
+    void setSolidRect(const sf::IntRect& rect) {
+        solidTexCoords = sf::FloatRect(rect);
+    }
+    
+    // Начало кадра: вершины остаются выделенными, сбрасываются только счетчики
+    void begin() {
+        for (auto& layer : layers) {
+            layer.used = 0;
+        }
+        drawCalls = 0;
+        quadCount = 0;
+    }
+    
+    void addSprite(std::size_t layer, const sf::IntRect& texRect, const sf::FloatRect& dest, sf::Color color = sf::Color::White) {
+        writeQuad(allocateQuad(layer), dest, sf::FloatRect(texRect), color);
+    }
+    
+    void addRect(std::size_t layer, const sf::FloatRect& dest, sf::Color color) {
+        writeQuad(allocateQuad(layer), dest, solidTexCoords, color);
+    }
+    
+    // Отрисовка всех слоев по порядку: один вызов draw на непустой слой
+    void flush(sf::RenderTarget& target) {
+        for (const auto& layer : layers) {
+            if (layer.used == 0) {
+                continue;
+            }
+            sf::RenderStates states;
+            states.texture = layer.texture;
+            target.draw(&layer.vertices[0], layer.used, sf::PrimitiveType::Triangles, states);
+            drawCalls++;
+        }
+    }
+    
+    std::size_t getDrawCalls() const { return drawCalls; }
+    std::size_t getQuadCount() const { return quadCount; }
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Очередь фиксированной емкости без блокировок: один поток кладет, другой забирает.
+// Индексы только растут, позиция в массиве - остаток от деления на Capacity.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+private:
+    static_assert((Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+    
+    T items[Capacity];
+    alignas(64) std::atomic<std::size_t> head{0}; // Следующий на чтение
+    alignas(64) std::atomic<std::size_t> tail{0}; // Следующий на запись
+
+public:
+    // Возвращает false, если очередь заполнена
+    bool push(const T& value) {
+        std::size_t position = tail.load(std::memory_order_relaxed);
+        if (position - head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[position & (Capacity - 1)] = value;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Возвращает false, если очередь пуста
+    bool pop(T& value) {
+        std::size_t position = head.load(std::memory_order_relaxed);
+        if (position == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = items[position & (Capacity - 1)];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    
+    // Выбросить все непрочитанное; только пока читатель не работает
+    void clear() {
+        head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+    }
+};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+
+// Статичный экран (меню, управление, Game Over).
+// Тексты создаются один раз и рисуются в RenderTexture только после изменений
+// (строка, наведение мыши); в окно выводится готовая картинка одним спрайтом.
+// Координаты текстов логические, а RenderTexture - по числу пикселей, которые
+// экран занимает в окне, так что при любом размере окна картинка не мылится.
+class StaticScreen {
+private:
+    struct Item {
+        sf::Text text;
+        bool hoverable;
+    };
+    
+    sf::RenderTexture canvas;
+    bool hasCanvas = false;
+    sf::Vector2f logicalSize;
+    sf::Vector2u pixelSize;
+    sf::Color background;
+    std::vector<Item> items;
+    int hovered = -1;
+    bool dirty = true;
+    
+    // Цвет пункта под курсором
+    static sf::Color hoverColor() { return sf::Color::Yellow; }
+    
+    void drawItems(sf::RenderTarget& target) const {
+        target.clear(background);
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            if (static_cast<int>(i) == hovered) {
+                sf::Text highlighted = items[i].text;
+                highlighted.setFillColor(hoverColor());
+                target.draw(highlighted);
+            } else {
+                target.draw(items[i].text);
+            }
+        }
+    }
+
+public:
+    // Размер экрана в логических координатах; холст создается в resize
+    void create(sf::Vector2f size, sf::Color backgroundColor) {
+        logicalSize = size;
+        background = backgroundColor;
+        dirty = true;
+    }
+    
+    // Новый размер экрана в пикселях окна (после создания окна и Resized)
+    bool resize(sf::Vector2u pixels) {
+        hasCanvas = false;
+        dirty = true;
+        if (logicalSize.x <= 0.0f || logicalSize.y <= 0.0f || pixels.x == 0 || pixels.y == 0) {
+            return false;
+        }
+        pixelSize = pixels;
+        hasCanvas = canvas.resize(pixels);
+        if (hasCanvas) {
+            canvas.setSmooth(true);
+            canvas.setView(sf::View(sf::FloatRect({0.0f, 0.0f}, logicalSize)));
+        }
+        return hasCanvas;
+    }
+    
+    std::size_t addText(const sf::Font& font, const std::string& string, unsigned size,
+                        sf::Color color, sf::Vector2f position, bool hoverable = false) {
+        sf::Text text(font, string, size);
+        text.setFillColor(color);
+        text.setPosition(position);
+        items.push_back({text, hoverable});
+        dirty = true;
+        return items.size() - 1;
+    }
+    
+    void setString(std::size_t index, const std::string& string) {
+        items[index].text.setString(string);
+        dirty = true;
+    }
+    
+    bool contains(std::size_t index, sf::Vector2f point) const {
+        return index < items.size() && items[index].text.getGlobalBounds().contains(point);
+    }
+    
+    // Возвращает true, если подсветка сменилась и экран надо перерисовать
+    bool updateHover(sf::Vector2f point) {
+        int newHovered = -1;
+        for (std::size_t i = 0; i < items.size(); ++i) {
+            if (items[i].hoverable && items[i].text.getGlobalBounds().contains(point)) {
+                newHovered = static_cast<int>(i);
+                break;
+            }
+        }
+        if (newHovered == hovered) {
+            return false;
+        }
+        hovered = newHovered;
+        dirty = true;
+        return true;
+    }
+    
+    void draw(sf::RenderTarget& target) {
+        // Без RenderTexture экран рисуется напрямую, как раньше
+        if (!hasCanvas) {
+            drawItems(target);
+            return;
+        }
+        if (dirty) {
+            drawItems(canvas);
+            canvas.display();
+            dirty = false;
+        }
+        target.clear(background);
+        sf::Sprite sprite(canvas.getTexture());
+        sprite.setScale({logicalSize.x / pixelSize.x, logicalSize.y / pixelSize.y});
+        target.draw(sprite);
+    }
+};
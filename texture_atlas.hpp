@@ -0,0 +1,104 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <iostream>
+
+// Атлас: все картинки упакованы в одну текстуру, спрайты ссылаются на прямоугольники
+class TextureAtlas {
+private:
+    struct Pending {
+        std::string name;
+        sf::Image image;
+    };
+    
+    sf::Texture texture;
+    std::unordered_map<std::string, sf::IntRect> regions;
+    std::vector<Pending> pending;
+    
+    // Отступ между картинками, чтобы соседи не просвечивали при масштабировании
+    static const unsigned PADDING = 2;
+
+public:
+    // Добавление картинки до сборки атласа (декодирует файлы AssetLoader)
+    void add(const std::string& name, sf::Image&& image) {
+        if (image.getSize().x == 0 || image.getSize().y == 0) {
+            return;
+        }
+        pending.push_back({name, std::move(image)});
+    }
+    
+    // Упаковка полками по убыванию высоты и загрузка в видеопамять
+    bool build(unsigned atlasWidth = 1024) {
+        if (pending.empty()) {
+            return false;
+        }
+        
+        unsigned maxSize = sf::Texture::getMaximumSize();
+        atlasWidth = std::min(atlasWidth, maxSize);
+        
+        std::vector<std::size_t> order(pending.size());
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+            return pending[a].image.getSize().y > pending[b].image.getSize().y;
+        });
+        
+        std::vector<sf::Vector2u> positions(pending.size());
+        unsigned x = PADDING;
+        unsigned y = PADDING;
+        unsigned shelfHeight = 0;
+        for (std::size_t index : order) {
+            sf::Vector2u size = pending[index].image.getSize();
+            if (size.x + PADDING * 2 > atlasWidth) {
+                std::cout << "Image is too wide for atlas: " << pending[index].name << std::endl;
+                return false;
+            }
+            if (x + size.x + PADDING > atlasWidth) {
+                x = PADDING;
+                y += shelfHeight + PADDING;
+                shelfHeight = 0;
+            }
+            positions[index] = {x, y};
+            x += size.x + PADDING;
+            shelfHeight = std::max(shelfHeight, size.y);
+        }
+        unsigned atlasHeight = y + shelfHeight + PADDING;
+        if (atlasHeight > maxSize) {
+            std::cout << "Atlas does not fit into " << maxSize << "x" << maxSize << " texture" << std::endl;
+            return false;
+        }
+        
+        sf::Image atlasImage({atlasWidth, atlasHeight}, sf::Color::Transparent);
+        for (std::size_t i = 0; i < pending.size(); ++i) {
+            sf::Vector2u size = pending[i].image.getSize();
+            if (!atlasImage.copy(pending[i].image, positions[i])) {
+                continue;
+            }
+            regions[pending[i].name] = sf::IntRect({static_cast<int>(positions[i].x), static_cast<int>(positions[i].y)},
+                                                   {static_cast<int>(size.x), static_cast<int>(size.y)});
+        }
+        pending.clear();
+        
+        if (!texture.loadFromImage(atlasImage)) {
+            regions.clear();
+            return false;
+        }
+        return true;
+    }
+    
+    const sf::Texture& getTexture() const { return texture; }
+    
+    bool has(const std::string& name) const {
+        return regions.find(name) != regions.end();
+    }
+    
+    sf::IntRect get(const std::string& name) const {
+        auto it = regions.find(name);
+        return it != regions.end() ? it->second : sf::IntRect();
+    }
+};
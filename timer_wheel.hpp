@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+
+// Двухуровневое колесо таймеров по тикам.
+// Таймер - это событие из перечисления (не больше одного ожидающего таймера на
+// событие), поэтому колесо хранится в простых массивах и копируется вместе с миром.
+// Первый уровень - 256 ячеек по одному тику, второй - 64 ячейки по 256 тиков;
+// раз в 256 тиков ячейка второго уровня раскладывается по первому. За тик
+// просматриваются только таймеры, срабатывающие в этот тик.
+template <int EventCount>
+class TimerWheel {
+private:
+    static_assert(EventCount <= 127, "event indices are stored as 8 bits");
+    
+    static const int NEAR_SLOTS = 256;
+    static const int FAR_SLOTS = 64;
+    static const int NO_EVENT = -1;
+    
+    long long now = 0;
+    long long due[EventCount] = {};
+    std::int8_t next[EventCount] = {};
+    std::int8_t prev[EventCount] = {};
+    std::int16_t slotOf[EventCount] = {};
+    std::int8_t heads[NEAR_SLOTS + FAR_SLOTS] = {};
+    
+    void link(int event) {
+        long long delta = due[event] - now;
+        int slot;
+        if (delta < NEAR_SLOTS) {
+            slot = static_cast<int>(due[event] & (NEAR_SLOTS - 1));
+        } else {
+            // Слишком далекие таймеры ждут в последней ячейке и раскладываются заново
+            long long block = due[event] / NEAR_SLOTS;
+            long long lastBlock = now / NEAR_SLOTS + FAR_SLOTS - 1;
+            slot = NEAR_SLOTS + static_cast<int>((block < lastBlock ? block : lastBlock) & (FAR_SLOTS - 1));
+        }
+        slotOf[event] = static_cast<std::int16_t>(slot);
+        prev[event] = NO_EVENT;
+        next[event] = heads[slot];
+        if (heads[slot] != NO_EVENT) {
+            prev[heads[slot]] = static_cast<std::int8_t>(event);
+        }
+        heads[slot] = static_cast<std::int8_t>(event);
+    }
+    
+    void unlink(int event) {
+        int slot = slotOf[event];
+        if (prev[event] != NO_EVENT) {
+            next[prev[event]] = next[event];
+        } else {
+            heads[slot] = next[event];
+        }
+        if (next[event] != NO_EVENT) {
+            prev[next[event]] = prev[event];
+        }
+        slotOf[event] = NO_EVENT;
+    }
+    
+    // Переход в новый блок из 256 тиков: его таймеры переходят на первый уровень
+    void cascade() {
+        int slot = NEAR_SLOTS + static_cast<int>((now / NEAR_SLOTS) & (FAR_SLOTS - 1));
+        int event = heads[slot];
+        heads[slot] = NO_EVENT;
+        while (event != NO_EVENT) {
+            int following = next[event];
+            link(event);
+            event = following;
+        }
+    }
+
+public:
+    TimerWheel() {
+        clear(0);
+    }
+    
+    // Сброс всех таймеров; tick - текущий (уже обработанный) тик
+    void clear(long long tick) {
+        now = tick;
+        for (int i = 0; i < NEAR_SLOTS + FAR_SLOTS; ++i) {
+            heads[i] = NO_EVENT;
+        }
+        for (int i = 0; i < EventCount; ++i) {
+            slotOf[i] = NO_EVENT;
+        }
+    }
+    
+    // Срабатывание через delay тиков (не меньше 1); старый таймер события заменяется
+    void schedule(int event, long long delay) {
+        cancel(event);
+        due[event] = now + (delay > 0 ? delay : 1);
+        link(event);
+    }
+    
+    void cancel(int event) {
+        if (slotOf[event] != NO_EVENT) {
+            unlink(event);
+        }
+    }
+    
+    bool isScheduled(int event) const {
+        return slotOf[event] != NO_EVENT;
+    }
+    
+    // Сколько тиков осталось до срабатывания (0, если таймер не запущен)
+    long long remaining(int event) const {
+        return isScheduled(event) ? due[event] - now : 0;
+    }
+    
+    // Продвижение до тика tick с вызовом onFire(event) для сработавших таймеров.
+    // Обработчик может снова запустить этот или другой таймер.
+    template <typename Handler>
+    void advance(long long tick, Handler onFire) {
+        while (now < tick) {
+            now++;
+            if (now % NEAR_SLOTS == 0) {
+                cascade();
+            }
+            int slot = static_cast<int>(now & (NEAR_SLOTS - 1));
+            while (heads[slot] != NO_EVENT) {
+                int event = heads[slot];
+                unlink(event);
+                onFire(event);
+            }
+        }
+    }
+};
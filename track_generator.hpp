@@ -0,0 +1,394 @@
+#pragma once
+
+#include <bitset>
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <algorithm>
+#include "simulation.hpp"
+#include "spsc_queue.hpp"
+
+// Трасса строится кусками по TRACK_CHUNK_LENGTH пикселей пройденного пути.
+// Кусок - чистая функция (seed, номер, период спавна): набирается из рядов
+// по шаблонам ниже и проверяется на проходимость, поэтому его можно строить
+// заранее в фоновом потоке (TrackFeed) или прямо на месте - выйдет одно и то же.
+const float TRACK_CHUNK_LENGTH = 3000.0f;
+// Пустые поля в начале и в конце куска: между последним препятствием одного
+// куска и первым следующего игрок успевает приземлиться и уйти на любую полосу,
+// так что проходимость кусков по отдельности дает проходимость всей трассы
+const float TRACK_CHUNK_MARGIN = 300.0f;
+const int TRACK_MAX_OBSTACLES = 64;
+const int TRACK_RAMP_CHUNKS = 12; // Через столько кусков (около двух минут) сложность максимальна
+const int TRACK_ATTEMPTS = 8; // Попыток собрать проходимый кусок, потом - только одиночные препятствия
+// На столько пикселей препятствия увеличены при проверке: проходимый кусок
+// проходим с запасом в несколько тиков, а не только идеальными нажатиями
+const float TRACK_SLACK = 15.0f;
+
+// Размеры препятствий по типу: 0 - лавка, 1 - гараж
+const float OBSTACLE_WIDTHS[2] = {60.0f, 80.0f};
+const float OBSTACLE_HEIGHTS[2] = {30.0f, 80.0f};
+
+// Эталонный бегун для проверки проходимости - значения GameWorld по умолчанию
+constexpr float TRACK_BASE_SPEED = 300.0f;
+constexpr float TRACK_PLAYER_Y = 500.0f;
+constexpr float TRACK_PLAYER_HEIGHT = 50.0f;
+constexpr float TRACK_JUMP_SPEED = 400.0f;
+constexpr float TRACK_JUMP_HEIGHT = 150.0f;
+
+struct TrackObstacle {
+    float distance = 0.0f; // От начала куска; препятствие появляется над экраном, когда дорога пройдет это место
+    std::int8_t lane = 0;
+    std::int8_t type = 0;
+};
+
+// Готовый кусок трассы, препятствия по возрастанию distance
+struct TrackChunk {
+    std::uint64_t seed = 0;
+    long long index = -1; // -1 - пустой
+    int spacingTicks = 0;
+    int count = 0;
+    TrackObstacle obstacles[TRACK_MAX_OBSTACLES];
+    
+    bool matches(std::uint64_t runSeed, long long chunkIndex, int spacing) const {
+        return index == chunkIndex && seed == runSeed && spacingTicks == spacing;
+    }
+};
+
+// Шаблон: до трех рядов по три полосы. '.' - пусто, 'B' - лавка, 'G' - гараж,
+// '?' - что угодно. Вес плавно переходит от easyWeight к hardWeight.
+struct TrackTemplate {
+    int easyWeight;
+    int hardWeight;
+    int rowCount;
+    const char* rows[3];
+};
+
+const TrackTemplate TRACK_TEMPLATES[] = {
+    {8, 2, 1, {"?.."}},               // Одно препятствие, как раньше
+    {3, 1, 1, {"..."}},               // Передышка
+    {2, 3, 1, {"B.B"}},               // Две лавки
+    {1, 4, 1, {"GG."}},               // Свободна одна полоса
+    {1, 3, 1, {"BBB"}},               // Только прыжок
+    {0, 3, 1, {"GBG"}},               // Прыжок на единственной полосе
+    {0, 3, 3, {"G..", ".G.", "..G"}}, // Лесенка
+    {0, 2, 2, {"G.G", "B.B"}},        // Коридор
+    {0, 2, 2, {"GG.", ".GG"}},        // Перестроение
+};
+const int TRACK_TEMPLATE_COUNT = sizeof(TRACK_TEMPLATES) / sizeof(TRACK_TEMPLATES[0]);
+
+// Шаблоны пишутся для полос 0, 1, 2 и ставятся в случайной перестановке
+const int TRACK_LANE_ORDERS[6][3] = {{0, 1, 2}, {0, 2, 1}, {1, 0, 2}, {1, 2, 0}, {2, 0, 1}, {2, 1, 0}};
+
+// Проверка проходимости: по тикам отслеживаются все достижимые состояния
+// бегуна - полоса и фаза прыжка (0 - на земле, 1..airTicks - в воздухе).
+// За тик можно сместиться на соседнюю полосу и, стоя на земле, прыгнуть.
+// На земле опасно все, в воздухе - только гаражи; бусты (мопед, макасин) не
+// учитываются, так что кусок проходим и без них.
+class TrackSolver {
+public:
+    static const int MAX_PHASES = 128;
+    using Phases = std::bitset<MAX_PHASES>;
+
+private:
+    static const int MAX_HEIGHT = static_cast<int>(TRACK_JUMP_HEIGHT) + 8;
+    
+    float heights[MAX_PHASES] = {}; // Высота прыжка по фазам, как в GameWorld::jumpSystem
+    int airTicks = 0;
+    // lowerThan[k] - фазы, где высота меньше k пикселей: столкновение с
+    // препятствием задает диапазон высот, а он - две маски вместо обхода фаз
+    Phases lowerThan[MAX_HEIGHT + 2];
+    
+    // Фазы с высотой в [low, high], расширенном до целых пикселей
+    Phases heightRange(float low, float high) const {
+        int from = std::min(std::max(static_cast<int>(std::floor(low)), 0), MAX_HEIGHT + 1);
+        int to = std::min(std::max(static_cast<int>(std::ceil(high)) + 1, 0), MAX_HEIGHT + 1);
+        return lowerThan[to] & ~lowerThan[from];
+    }
+
+public:
+    TrackSolver() {
+        const float step = TRACK_JUMP_SPEED * TICK_DT;
+        float height = 0.0f;
+        bool rising = true;
+        while (airTicks + 1 < MAX_PHASES) {
+            if (rising) {
+                height += step;
+                rising = height < TRACK_JUMP_HEIGHT;
+            } else {
+                height -= step;
+                if (height <= 0.0f) {
+                    break; // Приземление: снова фаза 0
+                }
+            }
+            heights[++airTicks] = height;
+        }
+        for (int k = 0; k <= MAX_HEIGHT + 1; ++k) {
+            for (int phase = 0; phase <= airTicks; ++phase) {
+                lowerThan[k].set(phase, heights[phase] < k);
+            }
+        }
+    }
+    
+    // Проходим ли кусок на скорости дороги speed (пикселей в секунду)
+    bool passable(const TrackChunk& chunk, float speed) const {
+        if (chunk.count == 0) {
+            return true;
+        }
+        const float step = speed * TICK_DT;
+        const float top = TRACK_PLAYER_Y - TRACK_JUMP_HEIGHT - TRACK_SLACK; // Выше этого бегун не бывает
+        const float bottom = TRACK_PLAYER_Y + TRACK_PLAYER_HEIGHT + TRACK_SLACK;
+        const float finish = chunk.obstacles[chunk.count - 1].distance + OBSTACLE_HEIGHTS[1] + bottom;
+        
+        Phases grounded;
+        grounded.set(0);
+        Phases lanes[3];
+        for (Phases& phases : lanes) {
+            phases.set(0);
+        }
+        int first = 0; // Препятствия до first уже ушли ниже бегуна
+        for (long long t = 1; t * step <= finish + step; ++t) {
+            const float travelled = t * step;
+            
+            // Ход: прыжок с земли или следующая фаза, затем смена полосы
+            Phases moved[3];
+            for (int lane = 0; lane < 3; ++lane) {
+                Phases next = lanes[lane] << 1;
+                bool landed = next.test(airTicks + 1);
+                next.reset(airTicks + 1);
+                next.set(0, lanes[lane].test(0) || landed);
+                moved[lane] = next;
+            }
+            for (int lane = 0; lane < 3; ++lane) {
+                lanes[lane] = moved[lane];
+                if (lane > 0) {
+                    lanes[lane] |= moved[lane - 1];
+                }
+                if (lane < 2) {
+                    lanes[lane] |= moved[lane + 1];
+                }
+            }
+            
+            // Столкновения с препятствиями, увеличенными на TRACK_SLACK
+            for (int i = first; i < chunk.count; ++i) {
+                const TrackObstacle& obstacle = chunk.obstacles[i];
+                if (obstacle.distance > travelled) {
+                    break;
+                }
+                const float height = OBSTACLE_HEIGHTS[obstacle.type];
+                const float y = travelled - obstacle.distance - height;
+                if (y > bottom) {
+                    if (i == first) {
+                        first++;
+                    }
+                    continue;
+                }
+                if (y + height < top) {
+                    continue;
+                }
+                // Пересечение при TRACK_PLAYER_Y - h < y + height и TRACK_PLAYER_Y - h + TRACK_PLAYER_HEIGHT > y
+                Phases blocked = heightRange(TRACK_PLAYER_Y - y - height - TRACK_SLACK, bottom - y);
+                if (obstacle.type != 1) {
+                    blocked &= grounded;
+                }
+                lanes[obstacle.lane] &= ~blocked;
+            }
+            if (lanes[0].none() && lanes[1].none() && lanes[2].none()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Проверка на обычной скорости и под энергетиком (скорость x1.2)
+    bool solvable(const TrackChunk& chunk) const {
+        return passable(chunk, TRACK_BASE_SPEED) && passable(chunk, TRACK_BASE_SPEED * 1.2f);
+    }
+};
+
+// Ряды куска по шаблонам; singlesOnly - только одиночные препятствия (проходимо всегда)
+inline void fillTrackChunk(Rng& rng, int ramp, float spacing, bool singlesOnly, TrackChunk& chunk) {
+    int weights[TRACK_TEMPLATE_COUNT];
+    int total = 0;
+    for (int i = 0; i < TRACK_TEMPLATE_COUNT; ++i) {
+        const TrackTemplate& pattern = TRACK_TEMPLATES[i];
+        weights[i] = singlesOnly ? (i == 0) : pattern.easyWeight * (TRACK_RAMP_CHUNKS - ramp) + pattern.hardWeight * ramp;
+        total += weights[i];
+    }
+    
+    chunk.count = 0;
+    float distance = TRACK_CHUNK_MARGIN;
+    const float last = TRACK_CHUNK_LENGTH - TRACK_CHUNK_MARGIN;
+    while (distance <= last) {
+        int roll = rng.nextInt(total);
+        int chosen = 0;
+        while (roll >= weights[chosen]) {
+            roll -= weights[chosen];
+            chosen++;
+        }
+        const TrackTemplate& pattern = TRACK_TEMPLATES[chosen];
+        const int* order = TRACK_LANE_ORDERS[rng.nextInt(6)];
+        for (int row = 0; row < pattern.rowCount && distance <= last; ++row) {
+            for (int lane = 0; lane < 3; ++lane) {
+                char cell = pattern.rows[row][lane];
+                if (cell == '.' || chunk.count == TRACK_MAX_OBSTACLES) {
+                    continue;
+                }
+                TrackObstacle& obstacle = chunk.obstacles[chunk.count++];
+                obstacle.distance = distance;
+                obstacle.lane = static_cast<std::int8_t>(order[lane]);
+                obstacle.type = static_cast<std::int8_t>(cell == 'B' ? 0 : cell == 'G' ? 1 : rng.nextInt(2));
+            }
+            distance += spacing;
+        }
+    }
+}
+
+// Кусок index трассы забега seed. spacingTicks - период спавна препятствий
+// (GameWorld::obstacleSpawnTicks): ряды идут на таком же расстоянии, на какое
+// дорога уезжала между спавнами; в начале трассы ряды в полтора раза реже.
+inline void generateTrackChunk(std::uint64_t seed, long long index, int spacingTicks, TrackChunk& chunk) {
+    static const TrackSolver solver;
+    
+    Rng rng;
+    rng.seed(seed ^ (static_cast<std::uint64_t>(index) * 0xD1B54A32D192ED03ull));
+    chunk.seed = seed;
+    chunk.index = index;
+    chunk.spacingTicks = spacingTicks;
+    
+    int ramp = static_cast<int>(std::min<long long>(index, TRACK_RAMP_CHUNKS));
+    float base = std::max(spacingTicks, 1) * TRACK_BASE_SPEED * TICK_DT;
+    float spacing = base * (1.5f - 0.5f * ramp / TRACK_RAMP_CHUNKS);
+    for (int attempt = 0; attempt < TRACK_ATTEMPTS; ++attempt) {
+        fillTrackChunk(rng, ramp, spacing, false, chunk);
+        if (solver.solvable(chunk)) {
+            return;
+        }
+    }
+    fillTrackChunk(rng, ramp, std::max(spacing, TRACK_CHUNK_MARGIN), true, chunk);
+}
+
+// Подача готовых кусков в симуляцию. Фоновый поток строит куски на
+// QUEUE_CHUNKS вперед и кладет их в очередь без блокировок; поток симуляции
+// забирает их в маленький кэш. Если нужного куска там нет (начало забега,
+// новый seed, перемотка далеко назад), он строится на месте, а фоновый поток
+// получает новое задание - строить с места, где теперь игра. Поток один на
+// все время жизни TrackFeed: новый забег его только перенаправляет, а не
+// пересоздает. Все вызовы get - из одного потока.
+class TrackFeed {
+private:
+    static const std::size_t QUEUE_CHUNKS = 8;
+    static const int CACHE_CHUNKS = 4;
+    
+    SpscQueue<TrackChunk, QUEUE_CHUNKS> ready;
+    TrackChunk cache[CACHE_CHUNKS];
+    std::thread producer;
+    
+    // Задание фоновому потоку: забег и первый кусок. Пишет только get под
+    // jobMutex; номер задания растет с каждым новым, по нему поток бросает старое.
+    std::mutex jobMutex;
+    std::condition_variable jobChanged;
+    std::atomic<unsigned> job{0};
+    std::atomic<bool> stopping{false};
+    std::uint64_t seed = 0;
+    int spacingTicks = 0;
+    long long jobFirst = 0;
+    long long queuedUpTo = -1; // Последний забранный из очереди кусок задания
+    
+    bool current(unsigned taken) const {
+        return job.load() == taken && !stopping.load(std::memory_order_relaxed);
+    }
+    
+    void produce() {
+        TrackChunk chunk;
+        unsigned taken = 0;
+        for (;;) {
+            std::uint64_t runSeed;
+            long long index;
+            int spacing;
+            {
+                std::unique_lock<std::mutex> lock(jobMutex);
+                jobChanged.wait(lock, [&]() { return stopping.load() || job.load() != taken; });
+                if (stopping.load()) {
+                    return;
+                }
+                taken = job.load();
+                runSeed = seed;
+                index = jobFirst;
+                spacing = spacingTicks;
+            }
+            // Куски подряд, пока не придет новое задание
+            for (; current(taken); ++index) {
+                generateTrackChunk(runSeed, index, spacing, chunk);
+                while (!ready.push(chunk) && current(taken)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+            }
+        }
+    }
+    
+    void restart(std::uint64_t runSeed, long long first, int spacing) {
+        {
+            std::lock_guard<std::mutex> lock(jobMutex);
+            seed = runSeed;
+            spacingTicks = spacing;
+            jobFirst = first;
+            job.fetch_add(1);
+        }
+        queuedUpTo = first - 1;
+        if (!producer.joinable()) {
+            producer = std::thread(&TrackFeed::produce, this);
+        }
+        jobChanged.notify_one();
+    }
+
+public:
+    // Сколько кусков пришлось строить на месте
+    long long builtInPlace = 0;
+    
+    TrackFeed() = default;
+    TrackFeed(const TrackFeed&) = delete;
+    TrackFeed& operator=(const TrackFeed&) = delete;
+    
+    ~TrackFeed() {
+        if (producer.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(jobMutex);
+                stopping.store(true);
+            }
+            jobChanged.notify_one();
+            producer.join();
+        }
+    }
+    
+    const TrackChunk& get(std::uint64_t runSeed, long long index, int spacing) {
+        TrackChunk& slot = cache[index % CACHE_CHUNKS];
+        if (slot.matches(runSeed, index, spacing)) {
+            return slot;
+        }
+        if (producer.joinable() && runSeed == seed && spacing == spacingTicks) {
+            // Задание идет подряд с jobFirst; куски прошлых заданий, которые поток
+            // успел положить, пропускаются (совпавший по номеру кусок - тот же самый)
+            TrackChunk chunk;
+            while (queuedUpTo < index && ready.pop(chunk)) {
+                if (chunk.matches(seed, queuedUpTo + 1, spacingTicks)) {
+                    queuedUpTo = chunk.index;
+                    cache[chunk.index % CACHE_CHUNKS] = chunk;
+                }
+            }
+            if (slot.matches(runSeed, index, spacing)) {
+                return slot;
+            }
+        }
+        builtInPlace++;
+        generateTrackChunk(runSeed, index, spacing, slot);
+        // Фоновый поток строит другой забег или отстал от игры
+        if (!producer.joinable() || runSeed != seed || spacing != spacingTicks || queuedUpTo < index) {
+            restart(runSeed, index + 1, spacing);
+        }
+        return slot;
+    }
+};
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <atomic>
+
+// Тройной буфер без блокировок: один писатель, один читатель.
+// У писателя и читателя по своему слоту, третий лежит посередине.
+// Писатель заполняет свой слот и меняет его местами со средним, читатель
+// забирает средний, только если туда положили новое. Никто никого не ждет:
+// писатель не затирает то, что сейчас читается, а читатель всегда получает
+// последний опубликованный слот (промежуточные просто пропускаются).
+template <typename T>
+class TripleBuffer {
+private:
+    static const unsigned FRESH = 4; // В среднем слоте новое, еще не забранное читателем
+    
+    T slots[3];
+    std::atomic<unsigned> middle{1};
+    unsigned back = 0;  // Слот писателя
+    unsigned front = 2; // Слот читателя
+
+public:
+    TripleBuffer() = default;
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+    
+    // Писатель: слот для заполнения и его публикация
+    T& writeSlot() {
+        return slots[back];
+    }
+    
+    void publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & ~FRESH;
+    }
+    
+    // Читатель: забрать последний опубликованный слот, если он новее текущего
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+        return true;
+    }
+    
+    const T& readSlot() const {
+        return slots[front];
+    }
+};
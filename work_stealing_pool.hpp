@@ -0,0 +1,174 @@
+#pragma once
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+// Пул потоков с перехватом работы для пачки независимых задач 0..count-1.
+// Каждый поток получает свой непрерывный отрезок индексов и берет задачи с его
+// начала. Закончив свой отрезок, поток забирает у соседа верхнюю половину
+// оставшегося, поэтому длинные и короткие задачи сами выравниваются по потокам.
+// Блокировка на отрезок берется один раз на задачу: для задач длиной в забег
+// это ничто, а общих счетчиков, за которые бились бы все ядра, нет.
+// Потоки создаются один раз в конструкторе и между пачками спят на условной
+// переменной, так что повторные run не платят за создание и join потоков.
+class WorkStealingPool {
+private:
+    struct alignas(64) Range {
+        std::mutex mutex;
+        std::size_t begin = 0;
+        std::size_t end = 0;
+    };
+    
+    unsigned threadCount;
+    std::unique_ptr<Range[]> ranges;
+    std::vector<std::thread> threads; // Потоки 1 .. threadCount - 1, поток 0 - вызывающий
+    
+    // Текущая пачка: задача без std::function - указатель на функцию и контекст.
+    // Пишется под mutex перед сменой номера пачки.
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    void (*runTask)(void* context, std::size_t index, unsigned worker) = nullptr;
+    void* taskContext = nullptr;
+    unsigned batch = 0;   // Номер пачки, растет с каждым run
+    unsigned workers = 0; // Сколько потоков участвует в пачке
+    unsigned active = 0;  // Сколько фоновых потоков еще не закончили пачку
+    bool quitting = false;
+    
+    template <typename Task>
+    static void invoke(void* context, std::size_t index, unsigned worker) {
+        (*static_cast<Task*>(context))(index, worker);
+    }
+    
+    // Следующая задача из своего отрезка; false, если он пуст
+    static bool takeOwn(Range& range, std::size_t& index) {
+        std::lock_guard<std::mutex> lock(range.mutex);
+        if (range.begin == range.end) {
+            return false;
+        }
+        index = range.begin++;
+        return true;
+    }
+    
+    // Перенос верхней половины чужого отрезка в свой (свой в этот момент пуст)
+    static bool steal(Range& victim, Range& own) {
+        std::size_t begin;
+        std::size_t end;
+        {
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            std::size_t left = victim.end - victim.begin;
+            if (left == 0) {
+                return false;
+            }
+            begin = victim.end - (left + 1) / 2;
+            end = victim.end;
+            victim.end = begin;
+        }
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.begin = begin;
+        own.end = end;
+        return true;
+    }
+    
+    // Свой отрезок пачки, потом чужие
+    void work(unsigned self) {
+        Range& own = ranges[self];
+        for (;;) {
+            std::size_t index;
+            while (takeOwn(own, index)) {
+                runTask(taskContext, index, self);
+            }
+            // Своего не осталось: обход соседей, начиная со следующего
+            bool stolen = false;
+            for (unsigned k = 1; k < workers && !stolen; ++k) {
+                stolen = steal(ranges[(self + k) % workers], own);
+            }
+            // Все отрезки пусты: недоделанное уже взято другими потоками
+            if (!stolen) {
+                return;
+            }
+        }
+    }
+    
+    // Фоновый поток: ждет пачку, работает, если в ней участвует, и снова ждет
+    void workerLoop(unsigned self) {
+        unsigned seen = 0;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return quitting || batch != seen; });
+                if (quitting) {
+                    return;
+                }
+                seen = batch;
+                if (self >= workers) {
+                    continue;
+                }
+            }
+            work(self);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0) {
+                idle.notify_one();
+            }
+        }
+    }
+
+public:
+    // По умолчанию по потоку на ядро
+    explicit WorkStealingPool(unsigned threads = std::thread::hardware_concurrency())
+        : threadCount(std::max(threads, 1u)), ranges(new Range[std::max(threads, 1u)]) {
+        for (unsigned w = 1; w < threadCount; ++w) {
+            this->threads.emplace_back(&WorkStealingPool::workerLoop, this, w);
+        }
+    }
+    
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quitting = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+    
+    unsigned size() const { return threadCount; }
+    
+    // task(index, worker) для каждого индекса из [0, count); worker - номер потока
+    // от 0 до size() - 1, по нему задача находит свои рабочие данные.
+    // Вызывающий поток работает как поток 0; возврат - когда сделано все.
+    // Пачки идут по одной: run вызывается из одного потока.
+    template <typename Task>
+    void run(std::size_t count, Task task) {
+        if (count == 0) {
+            return;
+        }
+        unsigned used = static_cast<unsigned>(std::min<std::size_t>(threadCount, count));
+        for (unsigned w = 0; w < used; ++w) {
+            ranges[w].begin = count * w / used;
+            ranges[w].end = count * (w + 1) / used;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            runTask = &invoke<Task>;
+            taskContext = &task;
+            workers = used;
+            active = used - 1;
+            batch++;
+        }
+        wake.notify_all();
+        work(0);
+        
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return active == 0; });
+    }
+};